@@ -8,6 +8,39 @@
 
 #include <stdint.h>
 
+/* Flags around each frame: 50 = 400 bits = 333ms at 1200 baud
+ * (preamble default; afsk_setPreambleFlags() changes it)
+ */
+#define AFSK_PREAMBLE_FLAGS  50
+#define AFSK_TAIL_FLAGS      3
+
+/* Modem profiles sharing the bit FIFO and the TIM3 sample path */
+typedef enum {
+    AFSK_PROFILE_AFSK300 = 0,  /* AFSK 1600/1800 Hz, 9600 Hz samples */
+    AFSK_PROFILE_AFSK1200,     /* Bell 202 AFSK 1200/2200 Hz, 9600 Hz samples */
+    AFSK_PROFILE_AFSK2400,     /* AFSK 2165/3970 Hz, 19200 Hz samples */
+    AFSK_PROFILE_G3RUH9600,    /* G3RUH FSK, scrambled baseband, 38400 Hz samples */
+    AFSK_PROFILE_COUNT
+} afsk_profile_id_t;
+
+typedef enum {
+    AFSK_KIND_AFSK = 0,        /* DDS tone pair, phase-continuous */
+    AFSK_KIND_FSK,             /* scrambled baseband, shaped pulses */
+} afsk_kind_t;
+
+/* Modem profile descriptor. All fields are compile-time constants. */
+typedef struct {
+    const char    *name;
+    afsk_kind_t    kind;
+    uint16_t       baud;
+    uint16_t       mark_hz;           /* AFSK only */
+    uint16_t       space_hz;          /* AFSK only */
+    uint32_t       sample_rate;       /* TIM3 update rate */
+    uint8_t        samples_per_bit;
+    uint16_t       phase_inc_mark;    /* DDS step, 4096 units per cycle */
+    uint16_t       phase_inc_space;
+} afsk_profile_t;
+
 /* Initialize the AFSK module - call once at startup */
 void afsk_Init(void);
 
@@ -17,19 +50,85 @@ void afsk_Init(void);
  */
 void afsk_generate(const uint8_t *frame, uint16_t frame_len);
 
+/* Line framing for afsk_generateRaw() */
+typedef enum {
+    AFSK_RAW_HDLC = 0,   /* flag preamble/tail, LSB first (FX.25) */
+    AFSK_RAW_IL2P,       /* 0x55 preamble/tail, MSB first, NRZ */
+} afsk_raw_t;
+
+/* Send a pre-framed block (FX.25 tag + RS block, IL2P frame) between
+ * preamble and tail, WITHOUT bit stuffing.
+ */
+void afsk_generateRaw(const uint8_t *data, uint16_t len, afsk_raw_t framing);
+
+/* Pre-rendered transmission: the stuffed frame body as packed line bits
+ * (LSB first, before line coding - the ISR still applies NRZI, or NRZ for
+ * IL2P, and for G3RUH scrambling, so one rendering serves every modem
+ * profile). Preamble and tail are added when it is played, like for
+ * generated frames.
+ */
+typedef struct {
+    uint8_t   *bits;        /* caller's buffer */
+    uint16_t   size;        /* bytes in bits[] */
+    uint32_t   nbits;
+    afsk_raw_t framing;     /* preamble/tail fill and line code */
+    uint8_t    overflow;
+} afsk_stream_t;
+
+/* Bytes needed to render a frame of len bytes (stuffing worst case) */
+#define AFSK_STREAM_BYTES(len)  (((len) * 8U * 6U / 5U + 7U) / 8U + 1U)
+
+/* Render like afsk_generate()/afsk_generateRaw() into s instead of the
+ * FIFO. Returns 0, or -1 if s is too small. Not while a frame is being
+ * generated; the ISR may keep playing.
+ */
+int afsk_render(const uint8_t *frame, uint16_t frame_len, afsk_stream_t *s);
+int afsk_renderRaw(const uint8_t *data, uint16_t len, afsk_raw_t framing, afsk_stream_t *s);
+
+/* Queue a rendered stream for the next afsk_start(). It is played in place;
+ * keep it unchanged until the transmission ends.
+ */
+void afsk_play(const afsk_stream_t *s);
+
+/* Preamble length in flags (fill bytes for IL2P) for frames queued from
+ * now on. The preamble is one flag replayed by the ISR, so any length
+ * costs the same to build.
+ */
+void afsk_setPreambleFlags(uint16_t flags);
+uint16_t afsk_getPreambleFlags(void);
+
 /* Start the AFSK transmission (enables timer output) */
 void afsk_start(void);
 
 /* Stop the AFSK transmission */
 void afsk_stop(void);
 
-/* Called by timer ISR at 9600 Hz sample rate */
+/* Select the modem profile. Only call while idle (!afsk_isBusy());
+ * the sample timer must then be reprogrammed to afsk_getSampleRate().
+ */
+void afsk_setProfile(afsk_profile_id_t id);
+
+/* Active profile */
+const afsk_profile_t *afsk_getProfile(void);
+
+/* Profile table lookup by baud rate; returns -1 if there is none */
+int afsk_findProfile(uint16_t baud);
+
+/* Sample rate (Hz) the timer ISR must run at for the active profile */
+uint32_t afsk_getSampleRate(void);
+
+/* Called by timer ISR at afsk_getSampleRate() */
 void afsk_timer_tick(void);
 
 /* Check if transmission is still in progress */
 uint8_t afsk_isBusy(void);
 
-/* Get number of bits remaining in FIFO (for debugging) */
+/* Samples are being played: afsk_start() until the frame has ended.
+ * A loaded frame that has not started yet is busy but not running.
+ */
+uint8_t afsk_isRunning(void);
+
+/* Get number of bits still to be sent (for debugging) */
 uint32_t afsk_getBitsRemaining(void);
 
 #endif /* AFSK_H */
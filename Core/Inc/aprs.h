@@ -2,6 +2,7 @@
 #define APRS_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 /* ================= EXTERNAL VARIABLES ================= */
 extern char src_call[10];
@@ -24,4 +25,103 @@ void APRS_SetPath2(const char *call, uint8_t ssid);
 
 void APRS_Send(const char *msg);
 
+/* ================= TELEMETRY ================= */
+#define APRS_TLM_ANALOG     5
+#define APRS_TLM_DIGITAL    8
+#define APRS_TLM_CHANNELS   (APRS_TLM_ANALOG + APRS_TLM_DIGITAL)
+#define APRS_TLM_B91_MAX    8280U   /* 91*91 - 1, base91 two-char range */
+
+/* Definition frames resent after every this many telemetry reports */
+#define APRS_TLM_DEF_EVERY  20
+
+typedef enum {
+    APRS_TLM_PARM = 0,
+    APRS_TLM_UNIT,
+    APRS_TLM_EQNS,
+    APRS_TLM_BITS,
+    APRS_TLM_DEF_COUNT
+} aprs_tlm_def_t;
+
+/* Telemetry definitions; strings are copied verbatim into the frames */
+typedef struct {
+    const char *name[APRS_TLM_CHANNELS];   /* PARM. */
+    const char *unit[APRS_TLM_CHANNELS];   /* UNIT. */
+    const char *eqns[APRS_TLM_ANALOG];     /* EQNS. "a,b,c" per channel */
+    uint8_t     bits_sense;                /* BITS. active-high mask, bit 0 = B1 */
+    const char *title;                     /* BITS. project title */
+} aprs_tlm_defs_t;
+
+/* Base91 digits (chars 33..123), most significant first, zero padded */
+void APRS_Base91(char *out, uint32_t value, uint8_t width);
+
+/* Standard report "T#sss,aaa,aaa,aaa,aaa,aaa,bbbbbbbb" (analog 0..255,
+ * digital bit 0 = B1, printed first, as in the compressed form).
+ * All APRS_Format* return the string length, or -1 if it does not fit.
+ */
+int APRS_FormatTelemetry(char *out, size_t size, uint16_t seq,
+                         const uint8_t analog[APRS_TLM_ANALOG], uint8_t digital);
+
+/* Base91 comment telemetry "|ss1122334455dd|": seq and analog 0..8280
+ * (clamped), n_analog 1..5, digital appended when with_digital != 0.
+ * Append to a status/position comment.
+ */
+int APRS_FormatCompressedTelemetry(char *out, size_t size, uint16_t seq,
+                                   const uint16_t *analog, uint8_t n_analog,
+                                   uint8_t with_digital, uint8_t digital);
+
+/* Definition frame: APRS message to the telemetry station itself,
+ * ":CALL-SS  :PARM.a,b,c..." etc.
+ */
+int APRS_FormatTelemetryDef(char *out, size_t size, const char *call, uint8_t ssid,
+                            aprs_tlm_def_t which, const aprs_tlm_defs_t *defs);
+
+/* Slow schedule for definition frames. Call once per telemetry report;
+ * returns the definition to send next, or -1 if none is due. Every
+ * APRS_TLM_DEF_EVERY reports, PARM/UNIT/EQNS/BITS are returned on the
+ * following four calls.
+ */
+int APRS_NextTelemetryDef(void);
+
+/* ================= POSITION ================= */
+/* Position fix in fixed point; the encoders use no floating point.
+ * Library only for now: the modem has no position source of its own.
+ */
+typedef struct {
+    int32_t  lat;           /* microdegrees, north positive */
+    int32_t  lon;           /* microdegrees, east positive */
+    uint16_t speed;         /* knots */
+    uint16_t course;        /* degrees, 0 = unknown, 360 = north */
+    int32_t  alt;           /* metres, Mic-E only, used when has_alt */
+    uint8_t  has_alt;
+    char     table;         /* symbol table '/' or '\\' (or overlay) */
+    char     symbol;        /* symbol code */
+} aprs_pos_t;
+
+/* Mic-E status, value is the A/B/C message bits of the destination */
+typedef enum {
+    APRS_MICE_EMERGENCY = 0,
+    APRS_MICE_PRIORITY,
+    APRS_MICE_SPECIAL,
+    APRS_MICE_COMMITTED,
+    APRS_MICE_RETURNING,
+    APRS_MICE_IN_SERVICE,
+    APRS_MICE_EN_ROUTE,
+    APRS_MICE_OFF_DUTY
+} aprs_mice_msg_t;
+
+/* Mic-E: latitude, status and longitude flags go into dest (6 chars +
+ * NUL, pass it to ax25_encode as the destination call, SSID 0), the rest
+ * into the info field "`lmhsdcST[alt}]comment" (9 bytes + comment).
+ * Info bytes can be outside printable ASCII, but never 0. Longitudes
+ * beyond 179 59.99 are sent as 179 59.99 (Mic-E has no 180).
+ */
+int APRS_FormatMicE(char dest[7], char *out, size_t size, const aprs_pos_t *pos,
+                    aprs_mice_msg_t msg, const char *comment);
+
+/* Compressed position "!TYYYYXXXXScsT" + comment (14 bytes + comment),
+ * course/speed included when either is non-zero.
+ */
+int APRS_FormatCompressedPosition(char *out, size_t size, const aprs_pos_t *pos,
+                                  const char *comment);
+
 #endif
@@ -33,4 +33,39 @@ void ax25_encode(uint8_t *out, uint16_t *len,
 #define AX25_PREAMBLE_FLAGS 10
 #define AX25_POSTAMBLE_FLAGS 3
 
+/* Frame constants (shared with the ground tools in Tools/) */
+#define AX25_FLAG           0x7E
+#define AX25_CTRL_UI        0x03
+#define AX25_PID_NO_L3      0xF0
+#define AX25_ADDR_LEN       7
+#define AX25_MAX_REPEATERS  2
+#define AX25_FCS_LEN        2
+/* dst + src + control + PID + FCS, empty payload */
+#define AX25_MIN_FRAME_LEN  (2 * AX25_ADDR_LEN + 2 + AX25_FCS_LEN)
+
+/* CRC-CCITT (X.25) frame check sequence over len bytes, already inverted.
+ * Transmitted low byte first after the frame data.
+ */
+uint16_t ax25_fcs(const uint8_t *data, uint16_t len);
+
+/* Decoded view of a received UI frame. info points into the frame buffer. */
+typedef struct {
+    char     dst[7];
+    uint8_t  dst_ssid;
+    char     src[7];
+    uint8_t  src_ssid;
+    char     path[AX25_MAX_REPEATERS][7];
+    uint8_t  path_ssid[AX25_MAX_REPEATERS];
+    uint8_t  path_count;
+    uint8_t  control;
+    uint8_t  pid;
+    const uint8_t *info;
+    uint16_t info_len;
+} ax25_frame_t;
+
+/* Parse a frame as produced by ax25_encode() (no flags, FCS included).
+ * Returns 0 on success, -1 on bad length, FCS or address field.
+ */
+int ax25_decode(const uint8_t *frame, uint16_t len, ax25_frame_t *out);
+
 #endif /* AX25_H */
@@ -0,0 +1,42 @@
+/* batch.h
+ * Packs several RS485 telemetry lines into one APRS status payload
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+
+/* APRS information field limit (data type identifier included) */
+#define BATCH_MAX_PAYLOAD  256
+/* Between lines in one payload. Not ',' or ';': the ground tools split
+ * fields within a line on those (Tools/telemetry.c)
+ */
+#define BATCH_SEPARATOR    '^'
+
+typedef struct {
+    char        buf[BATCH_MAX_PAYLOAD + 1];
+    uint16_t    len;            /* bytes in buf, prefix included */
+    uint8_t     count;          /* lines packed */
+    uint32_t    first_tick;     /* HAL tick of the oldest line */
+    const char *prefix;
+    const char *suffix;
+} batch_t;
+
+/* Payloads are prefix + line [^ line ...] + suffix */
+void batch_Init(batch_t *b, const char *prefix, const char *suffix);
+
+/* Append a line. Returns 0, or -1 if it does not fit next to the lines
+ * already queued (flush, then add again). A line too long for an empty
+ * batch is truncated.
+ */
+int batch_add(batch_t *b, const char *line, uint32_t now);
+
+/* Lines are waiting and the oldest is at least window_ms old */
+uint8_t batch_due(const batch_t *b, uint32_t now, uint32_t window_ms);
+
+/* Complete payload (suffix appended); call batch_clear() once sent */
+const char *batch_payload(batch_t *b);
+void batch_clear(batch_t *b);
+
+#endif /* BATCH_H */
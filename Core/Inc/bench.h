@@ -0,0 +1,14 @@
+/* bench.h
+ * On-target encoder benchmarks (DWT cycle counts)
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/* Encode a representative status frame through each framing path
+ * (AX.25 + stuffing, FX.25, IL2P) and print average cycles per frame and
+ * bits on air. The modulator must be idle; its FIFO is cleared afterwards.
+ */
+void bench_Framing(void (*print)(const char *s));
+
+#endif /* BENCH_H */
@@ -0,0 +1,44 @@
+/* clock.h
+ * Core clock profiles: low-power idle, HSI default, PLL boost for encode
+ * bursts. Only RCC, PWR and flash latency; the caller re-derives the
+ * peripherals that depend on the bus clocks (TIM3, UARTs, SWO).
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+typedef enum {
+    CLOCK_PROFILE_LP8 = 0,     /* HSI / 2, idle */
+    CLOCK_PROFILE_HSI16,       /* HSI, no PLL (reset default) */
+    CLOCK_PROFILE_PLL180,      /* HSI -> PLL, over-drive, encode bursts */
+    CLOCK_PROFILE_COUNT
+} clock_profile_id_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    hclk_hz;
+    uint8_t     pll;           /* SYSCLK from the PLL (HSI / m * n / p) */
+    uint8_t     pll_m, pll_p, pll_q, pll_r;
+    uint16_t    pll_n;
+    uint32_t    ahb_div;       /* RCC_SYSCLK_DIVx */
+    uint32_t    apb1_div;      /* RCC_HCLK_DIVx, PCLK1 <= 45 MHz */
+    uint32_t    apb2_div;      /* RCC_HCLK_DIVx, PCLK2 <= 90 MHz */
+    uint32_t    flash_latency;
+    uint32_t    vos;           /* PWR_REGULATOR_VOLTAGE_SCALEx */
+    uint8_t     overdrive;     /* needed above 168 MHz */
+} clock_profile_t;
+
+/* Switch the core clock. SysTick follows (HAL_InitTick). Returns -1 if
+ * the PLL or over-drive does not come up; the core then runs from HSI16.
+ */
+int clock_setProfile(clock_profile_id_t id);
+
+clock_profile_id_t clock_getProfile(void);
+const clock_profile_t *clock_profileInfo(clock_profile_id_t id);
+
+/* Profile id for an HCLK in MHz, or -1 */
+int clock_findProfile(uint32_t mhz);
+
+#endif /* CLOCK_H */
@@ -0,0 +1,77 @@
+/* dra818.h
+ * DRA818U AT-command driver: commands are queued, sent by interrupt and
+ * confirmed by the module's reply. dra_Poll() runs the exchange from the
+ * main loop, so configuration never blocks.
+ */
+
+#ifndef DRA818_H
+#define DRA818_H
+
+#include "main.h"
+
+#define DRA_QUEUE          6
+#define DRA_CMD_MAX        64
+/* Reply timeout per try. The first command also covers the module's
+ * power-up, so DRA_TRIES x DRA_REPLY_MS must exceed ~500 ms.
+ */
+#define DRA_REPLY_MS       250
+#define DRA_TRIES          5
+
+/* Frequencies in 100 Hz units, the module's resolution: 4352480 = 435.2480 MHz */
+#define DRA_FREQ_MIN       4000000UL
+#define DRA_FREQ_MAX       4800000UL
+
+typedef enum {
+    DRA_EV_NONE = 0,
+    DRA_EV_OK,          /* command acknowledged */
+    DRA_EV_FAILED       /* no or negative reply after DRA_TRIES */
+} dra_event_t;
+
+typedef struct {
+    uint32_t tx_freq;
+    uint32_t rx_freq;
+    uint8_t  wide;          /* 0 = 12.5 kHz, 1 = 25 kHz */
+    uint8_t  squelch;       /* 0 (open) .. 8 */
+    uint8_t  tx_ctcss;      /* CTCSS/CDCSS code, 0 = off */
+    uint8_t  rx_ctcss;
+} dra_group_t;
+
+/* Last completed command */
+typedef struct {
+    const char *name;
+    uint8_t     tries;
+    uint32_t    ms;         /* first send to reply */
+} dra_result_t;
+
+/* huart must have its IRQ enabled; starts receiving */
+void dra_Init(UART_HandleTypeDef *huart);
+
+/* Queue a command. Returns 0, or -1 if the queue is full or an argument
+ * is out of range.
+ */
+int dra_connect(void);
+int dra_setGroup(const dra_group_t *g);
+int dra_setVolume(uint8_t vol);                           /* 1..8 */
+/* Pre/de-emphasis, 300 Hz high-pass, 3 kHz low-pass: 0 or 1 each, passed
+ * through as the module takes them (AT+SETFILTER)
+ */
+int dra_setFilter(uint8_t emphasis, uint8_t highpass, uint8_t lowpass);
+
+/* Main loop: send, parse replies, retry. Returns what completed this call. */
+dra_event_t dra_Poll(uint32_t now);
+
+/* A command queued or waiting for its reply */
+uint8_t dra_busy(void);
+
+const dra_result_t *dra_result(void);
+/* Last acknowledged channel settings */
+const dra_group_t *dra_group(void);
+
+/* "435.2480" -> 4352480; -1 outside DRA_FREQ_MIN..DRA_FREQ_MAX */
+int dra_parseFreq(const char *s, uint32_t *freq);
+
+/* From HAL_UART_RxCpltCallback / HAL_UART_ErrorCallback */
+void dra_rxDone(UART_HandleTypeDef *huart);
+void dra_rxError(UART_HandleTypeDef *huart);
+
+#endif /* DRA818_H */
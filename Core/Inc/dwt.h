@@ -0,0 +1,22 @@
+/* dwt.h
+ * DWT cycle counter helpers (Cortex-M4) for benchmarks and ISR timing
+ */
+
+#ifndef DWT_H
+#define DWT_H
+
+#include "main.h"
+
+/* Enable the free-running cycle counter (idempotent) */
+static inline void dwt_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t dwt_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif /* DWT_H */
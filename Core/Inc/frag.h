@@ -0,0 +1,39 @@
+/* frag.h
+ * Splits records longer than one APRS frame into numbered fragments
+ */
+
+#ifndef FRAG_H
+#define FRAG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Fragment payload: ">#F" id "," index "/" count ":" chunk
+ *   id     2 hex digits, one per fragmented record (wraps at 256)
+ *   index  1..count, decimal
+ * The chunks concatenated give the record as it would have followed '>'
+ * in a single status frame. Tools/reasm.c puts them back together.
+ */
+#define FRAG_MAX_COUNT   16
+#define FRAG_HEADER_MAX  12     /* ">#Fxx,nn/nn:" */
+
+typedef struct {
+    const char *data;
+    uint16_t    len;
+    uint16_t    pos;
+    uint16_t    chunk;
+    uint8_t     id;
+    uint8_t     index;
+    uint8_t     count;
+} frag_t;
+
+/* Prepare to split data into payloads of at most max_payload bytes.
+ * Returns the fragment count, or -1 if more than FRAG_MAX_COUNT would be
+ * needed. data must stay valid until the last frag_next().
+ */
+int frag_Begin(frag_t *f, const char *data, uint16_t len, uint16_t max_payload, uint8_t id);
+
+/* Next fragment payload into out. Returns its length, 0 when done. */
+int frag_next(frag_t *f, char *out, size_t size);
+
+#endif /* FRAG_H */
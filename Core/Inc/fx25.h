@@ -0,0 +1,32 @@
+/* fx25.h
+ * FX.25 forward error correction wrapper for AX.25 frames
+ */
+
+#ifndef FX25_H
+#define FX25_H
+
+#include <stdint.h>
+
+#define FX25_TAG_LEN      8
+#define FX25_MAX_BLOCK    255
+/* Largest encoded output: correlation tag + full RS(255,k) block */
+#define FX25_MAX_OUT      (FX25_TAG_LEN + FX25_MAX_BLOCK)
+
+/* Build GF tables and generator polynomials - call once at startup */
+void fx25_Init(void);
+
+/* Wrap an AX.25 frame (as produced by ax25_encode(): no flags, FCS
+ * included) into an FX.25 transmission:
+ *   correlation tag (8 bytes) + RS block [flag, stuffed frame, flag, pad][check]
+ *
+ * check_bytes selects the code family (16, 32 or 64); the smallest block
+ * that holds the stuffed frame is used. Output bytes are sent LSB-first,
+ * unstuffed, through the normal NRZI modulator.
+ *
+ * Returns number of bytes written to out (<= FX25_MAX_OUT), or 0 if the
+ * frame does not fit (send it as plain AX.25 instead).
+ */
+uint16_t fx25_encode(const uint8_t *frame, uint16_t frame_len,
+                     uint8_t check_bytes, uint8_t *out);
+
+#endif /* FX25_H */
@@ -0,0 +1,32 @@
+/* g3ruh.h
+ * G3RUH / K9NG compatible 9600 bps FSK baseband helpers
+ */
+
+#ifndef G3RUH_H
+#define G3RUH_H
+
+#include <stdint.h>
+
+#define G3RUH_BAUD             9600U
+#define G3RUH_SAMPLES_PER_BIT  4U
+#define G3RUH_SAMPLE_RATE      (G3RUH_BAUD * G3RUH_SAMPLES_PER_BIT)  /* 38400 Hz */
+
+/* Shaped-pulse table: [last 4 line bits, newest in bit 0][sample in bit]
+ * -> 4-bit DAC level
+ */
+extern const uint8_t g3ruh_pulse[16][G3RUH_SAMPLES_PER_BIT];
+
+/* Initial scrambler state; receivers self-synchronise within 17 bits */
+#define G3RUH_LFSR_INIT  0U
+
+/* K9NG/G3RUH self-synchronising scrambler, polynomial 1 + x^12 + x^17.
+ * Takes one NRZI line bit, returns the scrambled bit.
+ */
+static inline __attribute__((always_inline)) uint8_t g3ruh_scramble(uint32_t *lfsr, uint8_t bit)
+{
+    uint8_t out = (uint8_t)((bit ^ (*lfsr >> 16) ^ (*lfsr >> 11)) & 1U);
+    *lfsr = (*lfsr << 1) | out;
+    return out;
+}
+
+#endif /* G3RUH_H */
@@ -0,0 +1,55 @@
+/* idle.h
+ * Low-power idle: WFI between interrupts, Stop mode through long quiet
+ * periods. Stop ends on the RTC wakeup timer (LSI, calibrated against the
+ * core clock) or on the first edge on the RS485 line (PA9).
+ */
+
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <stdint.h>
+
+/* Longest single Stop; the RTC sub-second counter that measures it wraps
+ * after 32768 ticks (1.4 s even with the LSI at its 47 kHz limit)
+ */
+#define IDLE_STOP_MAX_MS   1000U
+
+typedef enum {
+    IDLE_WAKE_TIMER = 0,
+    IDLE_WAKE_RS485,
+    IDLE_WAKE_OTHER,
+    IDLE_WAKE_SKIPPED       /* too short to be worth a Stop */
+} idle_wake_t;
+
+typedef struct {
+    uint32_t rtc_hz;        /* calibrated RTC tick, LSI / 2 */
+    uint32_t window_tick;   /* HAL tick at the last reset */
+    uint32_t sleeps;        /* WFI entries */
+    uint64_t sleep_us;      /* time in WFI */
+    uint32_t stops;
+    uint32_t stop_ms;       /* time in Stop */
+    uint32_t rs485_wakes;   /* Stops ended by line activity */
+    uint32_t lat_n;         /* timer wakes measured */
+    uint32_t lat_min_us, lat_max_us;
+    uint64_t lat_sum_us;
+} idle_stats_t;
+
+/* LSI, RTC and EXTI wake events; calibrates the LSI for ~50 ms (blocking) */
+void idle_Init(void);
+
+/* One WFI. Call with interrupts masked after checking there is no work:
+ * a pending interrupt still ends the WFI and is taken once unmasked.
+ */
+void idle_sleep(void);
+
+/* Stop mode for at most ms. The wakeup timer is set early by the worst
+ * wake latency seen so far and the LSI calibration margin, so the main
+ * loop runs again before ms has passed. The HAL tick is advanced by the
+ * time spent in Stop. The core clock must not be on the PLL.
+ */
+idle_wake_t idle_stop(uint32_t ms);
+
+const idle_stats_t *idle_stats(void);
+void idle_resetStats(void);
+
+#endif /* IDLE_H */
@@ -0,0 +1,39 @@
+/* il2p.h
+ * IL2P (Improved Layer 2 Protocol) encoder, max-FEC mode
+ */
+
+#ifndef IL2P_H
+#define IL2P_H
+
+#include <stdint.h>
+
+#define IL2P_SYNC_LEN        3
+#define IL2P_HEADER_LEN      13
+#define IL2P_HEADER_PARITY   2
+#define IL2P_MAX_PAYLOAD     1023
+#define IL2P_BLOCK_PARITY    16
+#define IL2P_MAX_BLOCK_DATA  239
+
+/* Largest encoded output for the payload buffer sizes used here */
+#define IL2P_MAX_OUT(payload) \
+    (IL2P_SYNC_LEN + IL2P_HEADER_LEN + IL2P_HEADER_PARITY + (payload) + \
+     (((payload) + IL2P_MAX_BLOCK_DATA - 1) / IL2P_MAX_BLOCK_DATA) * IL2P_BLOCK_PARITY)
+
+/* Build RS codes - call once at startup (after or instead of fx25_Init) */
+void il2p_Init(void);
+
+/* Translate an AX.25 frame from ax25_encode() (no flags, FCS included)
+ * into an IL2P frame:
+ *   sync word 0xF15E48 | scrambled header + RS(15,13) | scrambled payload
+ *   blocks + 16 RS check bytes each
+ *
+ * UI frames without digipeaters use the compact type 1 header (payload =
+ * info field); anything else is carried transparently (type 0, payload =
+ * whole frame without FCS). Output is sent MSB first, no bit stuffing.
+ *
+ * Returns bytes written to out (size max with IL2P_MAX_OUT()), 0 on error.
+ */
+uint16_t il2p_encode(const uint8_t *frame, uint16_t frame_len,
+                     uint8_t *out, uint16_t out_size);
+
+#endif /* IL2P_H */
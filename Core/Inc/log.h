@@ -0,0 +1,49 @@
+/* log.h
+ * Non-blocking debug log: binary records in a ring, drained by USART DMA
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include "main.h"
+#include "log_fmt.h"
+
+/* Ring size in bytes, power of two. 2 KB is ~180 ms of output at 115200. */
+#define LOG_RING_SIZE   2048U
+
+/* 0: records leave as binary, expanded on the ground by Tools/log_decode.
+ * 1: records are expanded to text lines by log_Poll() in the main loop,
+ *    for a plain terminal on the bench.
+ */
+#ifndef LOG_TEXT_OUTPUT
+#define LOG_TEXT_OUTPUT 0
+#endif
+
+/* huart must have a TX DMA stream linked (hdmatx) and its IRQs enabled */
+void log_Init(UART_HandleTypeDef *huart);
+
+/* Append one record; arguments as in the format of id (log_fmt.h).
+ * Main-loop context only (single producer). Never blocks: if the ring is
+ * full the record is dropped and counted, and a LOG_DROPPED record goes
+ * out once there is room again.
+ */
+void log_write(log_id_t id, ...);
+
+/* Free text as a LOG_TEXT record, trailing line ends removed */
+void log_text(const char *s);
+
+/* Main loop: starts the next transfer (text formatting when
+ * LOG_TEXT_OUTPUT)
+ */
+void log_Poll(void);
+
+/* From HAL_UART_TxCpltCallback */
+void log_txDone(UART_HandleTypeDef *huart);
+
+/* Nothing queued and no transfer in flight */
+uint8_t log_idle(void);
+
+/* Records dropped since boot */
+uint32_t log_dropped(void);
+
+#endif /* LOG_H */
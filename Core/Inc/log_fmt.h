@@ -0,0 +1,95 @@
+/* log_fmt.h
+ * Debug log record format and message table, shared by the firmware
+ * (Core/Src/log.c) and the host decoder (Tools/log_decode.c)
+ */
+
+#ifndef LOG_FMT_H
+#define LOG_FMT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Record on the wire:
+ *   LOG_SYNC, id, len, tick (ms, u32 LE), len bytes of arguments
+ * Arguments follow the conversions of the format string: "%s" is a
+ * length byte and the characters, every other conversion a u32 LE.
+ * Text is expanded from the format table, never sent.
+ */
+#define LOG_SYNC        0xA5
+#define LOG_HDR_LEN     7
+#define LOG_ARGS_MAX    255
+#define LOG_STR_MAX     120     /* longer %s arguments are cut */
+
+/* X(id, format) - append only, the host decoder must match the firmware */
+#define LOG_FORMATS(X) \
+    X(LOG_TEXT,           "%s") \
+    X(LOG_DROPPED,        "Log: %u records dropped") \
+    X(LOG_BANNER,         "=== BeliefSat OrbitRadio-5 APRS MODEM v2 ===") \
+    X(LOG_SYSCLK,         "SYSCLK: %lu Hz") \
+    X(LOG_HCLK,           "HCLK: %lu Hz") \
+    X(LOG_PCLK1,          "PCLK1: %lu Hz, TIM3 clk: %lu Hz") \
+    X(LOG_TIM3,           "TIM3 ARR: %lu, Sample rate: %lu Hz") \
+    X(LOG_RS485_LISTEN,   "RS485 listening...") \
+    X(LOG_MODEM,          "Modem: %s, %lu Hz, %u samples/bit") \
+    X(LOG_FX25,           "FX.25 %s") \
+    X(LOG_IL2P,           "IL2P %s") \
+    X(LOG_BATCH_SET,      "Batch window set") \
+    X(LOG_PREAMBLE_SET,   "Preamble set") \
+    X(LOG_TXGOV,          "TX budget: duty %ld ms, energy %ld mJ, keyed %lu ms, deferred %lu") \
+    X(LOG_UNKNOWN_CMD,    "RS485: unknown command") \
+    X(LOG_QUEUE_FULL,     "TX queue full, frame dropped") \
+    X(LOG_PRERENDERED,    "Pre-rendered frame: %lu bits") \
+    X(LOG_AX25_FRAME,     "AX.25 frame: %u bytes (payload: %u chars)") \
+    X(LOG_AFSK_QUEUED,    "AFSK bits queued: %lu") \
+    X(LOG_TX_DEFERRED,    "TX deferred: budget, %lu ms") \
+    X(LOG_PTT_ON,         "PTT ON") \
+    X(LOG_TX_STARTED,     "TX started...") \
+    X(LOG_TX_TIMEOUT,     "TX timeout!") \
+    X(LOG_TX_COMPLETE,    "TX complete: %lu ms") \
+    X(LOG_PTT_OFF,        "PTT OFF") \
+    X(LOG_BATCH,          "Batch: %u lines") \
+    X(LOG_FRAG_TOO_LONG,  "Frag: line too long") \
+    X(LOG_FRAG,           "Frag: %u fragments") \
+    X(LOG_OBC_BAD_RECORD, "OBC: bad record") \
+    X(LOG_OBC_BAD_FRAME,  "OBC: bad frame") \
+    X(LOG_TLM_NO_CHANGE,  "TLM: no change") \
+    X(LOG_TLM,            "TLM: %s") \
+    X(LOG_RS485_LINE,     "RS485: %s") \
+    X(LOG_DRA_CONFIG,     "Configuring DRA818U...") \
+    X(LOG_DRA_READY,      "DRA818U @ 435.2480 MHz ready") \
+    X(LOG_TICK_INTERVAL,  "Tick interval: n %lu, min %lu, mean %lu, max %lu cycles (nominal %lu)") \
+    X(LOG_TICK_EXEC,      "Tick ISR: n %lu, min %lu, mean %lu, max %lu cycles") \
+    X(LOG_TICK_HIST,      "%s hist: %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu") \
+    X(LOG_STATS_SET,      "Stats interval set") \
+    X(LOG_STAT,           "Stat %s: %lu") \
+    X(LOG_FASTISR,        "TIM3 ISR: %s") \
+    X(LOG_CLOCK,          "Clock: %s, HCLK %lu Hz") \
+    X(LOG_CLOCK_SET,      "Clock: burst %s, idle %s") \
+    X(LOG_IDLE,           "Idle: %lu ms, WFI %lu ms (%lu), Stop %lu ms (%lu, %lu by RS485)") \
+    X(LOG_IDLE_WAKE,      "Stop wake latency: n %lu, min %lu, mean %lu, max %lu us (RTC %lu Hz)") \
+    X(LOG_IDLE_SET,       "Idle: Stop after %lu ms") \
+    X(LOG_RATE,           "Sample rate: nominal %lu Hz, period %lu + %lu/%lu, measured %lu mHz (%ld ppm), rounded %ld ppm") \
+    X(LOG_RATE_SET,       "TIM3 dithering: %s") \
+    X(LOG_DRA_OK,         "DRA818U: %s ok, %u tries, %lu ms") \
+    X(LOG_DRA_FAILED,     "DRA818U: %s failed after %u tries") \
+    X(LOG_DRA_GROUP,      "DRA818U: TX %lu.%04lu MHz, RX %lu.%04lu MHz, squelch %u") \
+    X(LOG_FRAG_NO_ROOM,   "Frag: no room for %u fragments") \
+    X(LOG_TRACE,          "Trace: tick events %s, %lu events lost") \
+    X(LOG_OBC_REPLAY,     "OBC: %u bytes after a stray zero taken as text") \
+    X(LOG_CLOCK_FALLBACK, "Clock: burst refused for %lu ms, encoding at %s")
+
+typedef enum {
+#define LOG_FMT_ENUM(id, fmt) id,
+    LOG_FORMATS(LOG_FMT_ENUM)
+#undef LOG_FMT_ENUM
+    LOG_COUNT
+} log_id_t;
+
+extern const char *const log_formats[LOG_COUNT];
+
+/* Expand the arguments of one record to text (no line end).
+ * Returns the text length, or -1 for an unknown id or short arguments.
+ */
+int log_fmt_expand(char *out, size_t size, uint8_t id, const uint8_t *args, uint8_t len);
+
+#endif /* LOG_FMT_H */
@@ -79,11 +79,31 @@ extern "C" {
 #define SWO_GPIO_Port         GPIOB
 
 /* ===================== Buffer Size ===================== */
-#define LINE_BUF_SIZE         256
+#define LINE_BUF_SIZE         1024   /* lines over one frame are fragmented */
+
+/* ===================== Sample Path ===================== */
+/* Code run from SRAM (.RamFunc, copied by the startup code with .data).
+ * Never inlined, or a copy could end up in a flash caller.
+ */
+#define RAMFUNC               __attribute__((section(".RamFunc"), noinline))
+
+/* One BSRR word per 4-bit DAC level (set and reset halves), filled by
+ * DAC_PrecomputeMasks(); all four pins must be on GPIOA
+ */
+extern uint32_t dac_bsrr[16];
+
+__STATIC_FORCEINLINE void DAC_Write4(uint8_t v)
+{
+    GPIOA->BSRR = dac_bsrr[v & 0x0F];
+}
 
 /* ===================== Prototypes ===================== */
 void Error_Handler(void);
 
+/* TIM3 update handler, and whether TIM3_IRQHandler uses it instead of HAL */
+extern volatile uint8_t tim3_fast_isr;
+void TIM3_SampleIRQ(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,69 @@
+/* obc_link.h
+ * Binary OBC records on the RS-485 line: COBS framing + CRC-16
+ */
+
+#ifndef OBC_LINK_H
+#define OBC_LINK_H
+
+#include <stdint.h>
+
+/* Largest decoded record (type byte + fields), excluding the CRC */
+#define OBC_LINK_MAX_RECORD  128
+#define OBC_LINK_CRC_LEN     2
+/* COBS adds one code byte per 254 data bytes */
+#define OBC_LINK_MAX_FRAME   (OBC_LINK_MAX_RECORD + OBC_LINK_CRC_LEN + 2)
+/* Line idle this long ends an unterminated frame (obc_link_idle) */
+#define OBC_LINK_IDLE_MS     5
+
+/* Wire format, shared with the text command/telemetry lines:
+ *
+ *   0x00  COBS(record, crc_lo, crc_hi)  0x00
+ *
+ * The leading zero switches the receiver from text to binary; the
+ * trailing zero closes the frame and switches back, so back-to-back frames
+ * carry both delimiters (00 .. 00 00 .. 00). The CRC is ax25_fcs()
+ * (CRC-16/X.25) over the record, low byte first.
+ *
+ * A stray zero must not lock the text path out. The receiver gives up on
+ * a frame that overflows, fails to decode or is left open while the line
+ * is idle; if the bytes it held are printable they were a text line and
+ * are handed back (OBC_RX_REPLAY). A zero that closed a bad frame may
+ * open the next one, so the receiver stays binary after it.
+ */
+
+typedef enum {
+    OBC_RX_TEXT = 0,    /* byte belongs to the text line path */
+    OBC_RX_PENDING,     /* consumed by the binary receiver */
+    OBC_RX_RECORD,      /* record complete: see rec / rec_len */
+    OBC_RX_ERROR,       /* frame dropped (COBS, length or CRC error) */
+    OBC_RX_REPLAY       /* not a frame: text[0..text_len) go to the text path */
+} obc_rx_t;
+
+typedef struct {
+    uint8_t  buf[OBC_LINK_MAX_FRAME];
+    uint16_t len;
+    uint8_t  binary;
+    uint8_t  rec[OBC_LINK_MAX_FRAME];
+    uint8_t  text[OBC_LINK_MAX_FRAME + 1];
+    uint16_t text_len;
+    uint16_t rec_len;
+    uint32_t frames_ok;
+    uint32_t frames_bad;
+} obc_link_t;
+
+void obc_link_Init(obc_link_t *l);
+
+/* Feed one received byte */
+obc_rx_t obc_link_rx(obc_link_t *l, uint8_t b);
+
+/* The line has been idle for OBC_LINK_IDLE_MS and every byte was fed:
+ * an open frame is abandoned (OBC_RX_REPLAY or OBC_RX_ERROR if it held
+ * bytes), and the receiver is back in text mode. OBC_RX_PENDING if there
+ * was nothing to do.
+ */
+obc_rx_t obc_link_idle(obc_link_t *l);
+
+/* COBS decode; returns decoded length or -1 on a malformed frame */
+int obc_link_cobsDecode(const uint8_t *in, uint16_t len, uint8_t *out);
+
+#endif /* OBC_LINK_H */
@@ -0,0 +1,32 @@
+/* rs.h
+ * Table-driven Reed-Solomon encoder over GF(256), field polynomial 0x11D.
+ * Shared by the FX.25 and IL2P framers.
+ */
+
+#ifndef RS_H
+#define RS_H
+
+#include <stdint.h>
+
+#define RS_MAX_ROOTS  64
+
+/* One code: generator polynomial (index form) for nroots check symbols */
+typedef struct {
+    uint8_t nroots;
+    uint8_t genpoly[RS_MAX_ROOTS + 1];
+} rs_code_t;
+
+/* Build the GF(256) log/antilog tables - call once at startup */
+void rs_Init(void);
+
+/* Build the generator polynomial with roots alpha^(fcr+i), i = 0..nroots-1.
+ * FX.25 uses fcr = 1, IL2P uses fcr = 0. Requires rs_Init().
+ */
+void rs_InitCode(rs_code_t *rs, uint8_t nroots, uint8_t fcr);
+
+/* Systematic encode: len data bytes (len <= 255 - nroots, shortened code)
+ * -> rs->nroots check bytes.
+ */
+void rs_encode(const rs_code_t *rs, const uint8_t *data, uint16_t len, uint8_t *parity);
+
+#endif /* RS_H */
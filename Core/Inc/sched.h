@@ -0,0 +1,57 @@
+/* sched.h
+ * Priority-class scheduler for outgoing APRS frames
+ */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Information field limit of one queued frame */
+#define SCHED_MAX_PAYLOAD  256
+/* Frames queued across all classes */
+#define SCHED_SLOTS        16
+
+/* Highest priority first */
+typedef enum {
+    SCHED_ALARM = 0,    /* OBC alarms, health flags */
+    SCHED_TELEMETRY,    /* status lines, telemetry records, fragments */
+    SCHED_BEACON,       /* periodic identification */
+    SCHED_DEFS,         /* PARM/UNIT/EQNS/BITS */
+    SCHED_CLASS_COUNT
+} sched_class_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    min_interval_ms;    /* rate limit: at most one frame per interval */
+    uint32_t    aging_ms;           /* waiting this long raises a frame one class (0 = never) */
+} sched_class_cfg_t;
+
+void sched_Init(void);
+
+/* Queue a frame. If all slots are taken, the oldest frame of the lowest
+ * class below cls is dropped to make room. Returns 0, or -1 if the frame
+ * was not queued.
+ */
+int sched_push(sched_class_t cls, const char *payload, uint32_t now);
+
+/* Take the frame to send next: highest effective priority (class raised by
+ * aging) among classes whose rate limit allows a frame now, FIFO within a
+ * class. Returns its class, or -1 if nothing may be sent now.
+ */
+int sched_pop(char *out, size_t size, uint32_t now);
+
+/* Class and payload length of the frame sched_pop() would return now,
+ * without taking it (-1 if none)
+ */
+int sched_peek(uint16_t *len, uint32_t now);
+
+uint8_t sched_pending(sched_class_t cls);
+/* Frames of class cls sched_push() would accept now: free slots plus
+ * those it could evict
+ */
+uint8_t sched_room(sched_class_t cls);
+const sched_class_cfg_t *sched_classCfg(sched_class_t cls);
+
+#endif /* SCHED_H */
@@ -0,0 +1,68 @@
+/* stats.h
+ * Modem health counters: one block for every subsystem, reported as a
+ * compact status line ("$STATS" on RS485, optionally a periodic APRS frame)
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* X(id, name) - append only, the ground side reads the fields by position.
+ * Counters run from boot and wrap; peaks are high-water marks.
+ */
+#define STATS_COUNTERS(X) \
+    X(STAT_FRAMES,         "frames")        /* frames sent to the end */ \
+    X(STAT_TIMEOUTS,       "timeouts")      /* frames cut by the TX timeout */ \
+    X(STAT_AIRTIME_MS,     "airtime_ms")    /* PTT on to off, all frames */ \
+    X(STAT_DEFERRED,       "deferred")      /* frames held back by the TX budget */ \
+    X(STAT_FIFO_PEAK,      "fifo_peak")     /* modulator bit FIFO, bits */ \
+    X(STAT_UNDERRUNS,      "underruns")     /* FIFO ran dry mid-frame (body did not fit) */ \
+    X(STAT_QUEUE_PEAK,     "queue_peak")    /* scheduler slots in use */ \
+    X(STAT_QUEUE_FULL,     "queue_full")    /* frames refused by the scheduler */ \
+    X(STAT_QUEUE_EVICTED,  "evicted")       /* frames pushed out by higher classes */ \
+    X(STAT_LINES_DROPPED,  "lines_dropped") /* OBC lines that could not be framed */ \
+    X(STAT_RS485_OVERRUNS, "rs485_ovr")     /* receive ring full */ \
+    X(STAT_RS485_ERRORS,   "rs485_err")     /* framing/noise/overrun on USART1 */ \
+    X(STAT_OBC_ERRORS,     "obc_err")       /* bad binary frames and records */ \
+    X(STAT_DRA_ERRORS,     "dra_err")       /* DRA818U commands never acknowledged */ \
+    X(STAT_CLOCK_FALLBACK, "clk_fallback")  /* frames encoded without the burst clock */
+
+typedef enum {
+#define STATS_ENUM(id, name) id,
+    STATS_COUNTERS(STATS_ENUM)
+#undef STATS_ENUM
+    STAT_COUNT
+} stat_id_t;
+
+extern volatile uint32_t stats[STAT_COUNT];
+extern const char *const stats_names[STAT_COUNT];
+
+/* Safe from any context, including the TIM3 ISR: LDREX/STREX, no masking */
+static inline __attribute__((always_inline)) void stats_inc(stat_id_t id)
+{
+    __atomic_fetch_add(&stats[id], 1U, __ATOMIC_RELAXED);
+}
+
+static inline __attribute__((always_inline)) void stats_add(stat_id_t id, uint32_t n)
+{
+    __atomic_fetch_add(&stats[id], n, __ATOMIC_RELAXED);
+}
+
+/* Raise a high-water mark; a plain load when v is not a new peak */
+static inline __attribute__((always_inline)) void stats_peak(stat_id_t id, uint32_t v)
+{
+    uint32_t cur = __atomic_load_n(&stats[id], __ATOMIC_RELAXED);
+    while (v > cur &&
+           !__atomic_compare_exchange_n(&stats[id], &cur, v, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/* "STATS,<uptime s>,<mean airtime ms>,<counters in table order>"
+ * Returns the length, or -1 if it does not fit.
+ */
+int stats_format(char *out, size_t size, uint32_t uptime_s);
+
+#endif /* STATS_H */
@@ -0,0 +1,46 @@
+/* tickstat.h
+ * TIM3 sample ISR timing: inter-sample interval and execution time
+ * (DWT cycles), min/max/mean and histograms
+ */
+
+#ifndef TICKSTAT_H
+#define TICKSTAT_H
+
+#include <stdint.h>
+
+#define TICKSTAT_BINS           16
+/* Interval histogram: deviation from nominal, bin 8 = [0, +W) cycles,
+ * bins 0 and 15 collect everything beyond +-8 W
+ */
+#define TICKSTAT_INT_BIN_CYCLES   8
+/* Execution time histogram: bin n = [n W, (n+1) W), bin 15 open ended */
+#define TICKSTAT_EXEC_BIN_CYCLES  32
+
+typedef struct {
+    uint32_t nominal;                   /* expected interval, cycles */
+    uint32_t intervals;
+    uint32_t int_min, int_max;
+    uint64_t int_sum;
+    uint32_t ticks;
+    uint32_t exec_min, exec_max;
+    uint64_t exec_sum;
+    uint32_t int_hist[TICKSTAT_BINS];
+    uint32_t exec_hist[TICKSTAT_BINS];
+} tickstat_t;
+
+/* Clear the statistics; nominal is the TIM3 period in CPU cycles.
+ * Call whenever the sample rate or the core clock changes.
+ */
+void tickstat_Reset(uint32_t nominal_cycles);
+
+/* TIM3 was stopped: the next tick starts a new interval, statistics kept */
+void tickstat_restart(void);
+
+/* First and last thing in the TIM3 handler */
+void tickstat_enter(void);
+void tickstat_exit(void);
+
+/* Consistent copy (TIM3 masked while copying), cleared when reset != 0 */
+void tickstat_snapshot(tickstat_t *out, uint8_t reset);
+
+#endif /* TICKSTAT_H */
@@ -0,0 +1,100 @@
+/* tlm.h
+ * Schema-driven OBC telemetry: binary record decode and APRS encoding
+ */
+
+#ifndef TLM_H
+#define TLM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "aprs.h"
+
+/* Record type byte (first byte of every OBC record) */
+#define TLM_RECORD_HK       0x01
+
+/* Flags bits that make a record an alarm (Safe, Err) */
+#define TLM_ALARM_BITS      0x81
+
+/* Delta mode: a full frame goes out after this many records regardless */
+#define TLM_REFRESH_EVERY   10
+
+/* Field types on the wire, little-endian */
+typedef enum {
+    TLM_U8 = 0,
+    TLM_I8,
+    TLM_U16,
+    TLM_I16,
+    TLM_U32,
+    TLM_I32
+} tlm_type_t;
+
+/* APRS channel of a field */
+#define TLM_CH_NONE     (-1)    /* sent as text "name=value" */
+#define TLM_CH_DIGITAL  (APRS_TLM_ANALOG)   /* 8 status bits */
+
+typedef struct {
+    const char *name;       /* PARM. name / text key */
+    const char *unit;       /* UNIT. */
+    tlm_type_t  type;
+    int32_t     offset;     /* APRS value = (raw - offset) / scale */
+    uint16_t    scale;
+    const char *eqns;       /* EQNS. "a,b,c" giving units from the APRS value */
+    int8_t      channel;    /* 0..4 analog, TLM_CH_DIGITAL or TLM_CH_NONE */
+    uint32_t    deadband;   /* delta mode: resend once |raw - last sent| > this */
+} tlm_field_t;
+
+/* Decoded value of one field */
+typedef union {
+    int32_t  i;
+    uint32_t u;
+} tlm_slot_t;
+
+void tlm_Init(void);
+
+/* Decode one OBC record into the field slots.
+ * Returns 0, or -1 on unknown type or length mismatch (slots unchanged).
+ */
+int tlm_decode(const uint8_t *rec, uint16_t len);
+
+uint8_t tlm_fieldCount(void);
+const tlm_field_t *tlm_field(uint8_t idx);
+tlm_slot_t tlm_get(uint8_t idx);
+
+/* APRS value of a field (0..APRS_TLM_B91_MAX, clamped) */
+uint16_t tlm_aprsValue(uint8_t idx);
+
+/* Status payload for the current slots: channel fields as base91 comment
+ * telemetry, the remaining fields as "name=value" text.
+ * Returns the length, or -1 if it does not fit.
+ */
+int tlm_format(char *out, size_t size, uint16_t seq);
+
+/* Delta payload for the current slots, against the last values sent.
+ *
+ * Every TLM_REFRESH_EVERY records (and after tlm_forceRefresh()) this is
+ * the full tlm_format() frame. Otherwise only fields that moved beyond
+ * their deadband are sent:
+ *
+ *   ">D" ss { k vv }...
+ *
+ * with ss the sequence number (2 base91 digits), k = 'a' + field index and
+ * vv the field's APRS value (2 base91 digits), or for TLM_CH_NONE fields
+ * raw - offset (5 base91 digits). Full and delta frames share one
+ * sequence, so a ground station can rebuild the state from the last full
+ * frame plus the deltas that follow it.
+ *
+ * Returns the length, 0 if nothing changed (send nothing), or -1 if it
+ * does not fit.
+ */
+int tlm_formatDelta(char *out, size_t size, uint16_t seq);
+
+/* Make the next tlm_formatDelta() send a full frame */
+void tlm_forceRefresh(void);
+
+/* Any TLM_ALARM_BITS set in the digital field of the current slots */
+uint8_t tlm_isAlarm(void);
+
+/* PARM/UNIT/EQNS/BITS definitions matching tlm_format() */
+const aprs_tlm_defs_t *tlm_defs(void);
+
+#endif /* TLM_H */
@@ -0,0 +1,59 @@
+/* trace.h
+ * ITM/SWO event trace with DWT cycle stamps
+ *
+ * trace_event() is one store to a stimulus port (a few cycles), so it can
+ * sit in the TIM3 ISR without shifting the timing it measures. Capture
+ * SWO (PB3, NRZ 8N1 at TRACE_SWO_HZ) with a debug probe or a plain
+ * USB-UART, and turn it into a timeline with Tools/trace_parse.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "main.h"
+#include "trace_ev.h"
+
+/* 0 compiles every trace_event() out */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 1
+#endif
+
+/* SWO bit rate; HCLK must be a multiple of it */
+#define TRACE_SWO_HZ  2000000U
+
+extern uint8_t trace_on;
+extern volatile uint32_t trace_lost;
+
+/* Route SWO to PB3 and enable the ITM ports; again after a clock change */
+void trace_Init(uint32_t hclk_hz);
+
+/* Tick entry/exit events (ports TRACE_TICK_IN/OUT). Off by default: two
+ * words per sample nearly fill the SWO at the higher sample rates and
+ * crowd out every other event. A disabled port takes the store and
+ * drops it, so the ISR does not change.
+ */
+void trace_setTicks(uint8_t on);
+uint8_t trace_getTicks(void);
+
+/* Main loop: full CYCCNT on TRACE_PORT_SYNC at least every 2^23 cycles */
+void trace_Poll(void);
+
+/* The FIFO is never waited for: a full FIFO drops the event and counts it.
+ * Always inlined, also at -O0, so the SRAM sample path stays in SRAM.
+ */
+__STATIC_FORCEINLINE void trace_event(trace_ev_t ev, uint8_t arg)
+{
+#if TRACE_ENABLE
+    if (!trace_on) return;
+    if (ITM->PORT[ev].u32 == 0) {
+        trace_lost++;
+        return;
+    }
+    ITM->PORT[ev].u32 = ((uint32_t)arg << 24) | (DWT->CYCCNT & TRACE_STAMP_MASK);
+#else
+    (void)ev;
+    (void)arg;
+#endif
+}
+
+#endif /* TRACE_H */
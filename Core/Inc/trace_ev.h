@@ -0,0 +1,42 @@
+/* trace_ev.h
+ * ITM trace event table, shared by the firmware (Core/Inc/trace.h) and
+ * the host parser (Tools/trace_parse.c)
+ */
+
+#ifndef TRACE_EV_H
+#define TRACE_EV_H
+
+#include <stdint.h>
+
+/* Each event has its own stimulus port (event value = port number) and
+ * writes one 32-bit word: arg in bits 31..24, DWT->CYCCNT bits 23..0.
+ * TRACE_PORT_SYNC carries the full CYCCNT so the host can extend the
+ * 24-bit stamps.
+ */
+#define TRACE_PORT_SYNC     31U
+#define TRACE_STAMP_MASK    0x00FFFFFFUL
+
+/* X(event, name) - append only, the host parser must match the firmware */
+#define TRACE_EVENTS(X) \
+    X(TRACE_TICK_IN,      "tick_in")       /* arg: tick sequence number */ \
+    X(TRACE_TICK_OUT,     "tick_out")      /* arg: same as its tick_in */ \
+    X(TRACE_FRAME_START,  "frame_start") \
+    X(TRACE_FRAME_END,    "frame_end") \
+    X(TRACE_PTT_ON,       "ptt_on") \
+    X(TRACE_PTT_OFF,      "ptt_off") \
+    X(TRACE_Q_PUSH,       "q_push")        /* arg: class */ \
+    X(TRACE_Q_EVICT,      "q_evict")       /* arg: class of the evicted frame */ \
+    X(TRACE_Q_FULL,       "q_full")        /* arg: class of the dropped frame */ \
+    X(TRACE_Q_POP,        "q_pop")         /* arg: class */ \
+    X(TRACE_STOP_IN,      "stop_in") \
+    X(TRACE_STOP_OUT,     "stop_out")      /* arg: idle_wake_t */
+
+typedef enum {
+    TRACE_NONE = 0,     /* port 0 is left for printf-style ITM output */
+#define TRACE_EV_ENUM(ev, name) ev,
+    TRACE_EVENTS(TRACE_EV_ENUM)
+#undef TRACE_EV_ENUM
+    TRACE_EVENT_COUNT
+} trace_ev_t;
+
+#endif /* TRACE_EV_H */
@@ -0,0 +1,45 @@
+/* txgov.h
+ * Transmit duty-cycle and energy governor (token buckets over keyed time)
+ */
+
+#ifndef TXGOV_H
+#define TXGOV_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint16_t duty_permille;     /* average keyed fraction allowed */
+    uint32_t duty_window_ms;    /* burst: the bucket holds duty x window */
+    uint32_t tx_power_mw;       /* supply draw while keyed */
+    uint32_t energy_avg_mw;     /* average TX power allowed */
+    uint32_t energy_window_ms;  /* burst: the bucket holds avg x window */
+} txgov_cfg_t;
+
+typedef struct {
+    int64_t  duty_us;           /* keyed time left in the duty bucket */
+    int64_t  energy_uj;         /* energy left in the energy bucket */
+    uint32_t keyed_ms;          /* total keyed time */
+    uint32_t deferrals;         /* frames that had to wait for budget */
+    uint8_t  deferring;         /* the head frame is waiting now */
+} txgov_state_t;
+
+/* Buckets start full */
+void txgov_Init(const txgov_cfg_t *cfg, uint32_t now);
+
+/* May a transmission of about key_ms start now? Refills the buckets first.
+ * A frame that is refused stays queued and is asked about again later.
+ */
+uint8_t txgov_allow(uint32_t key_ms, uint32_t now);
+
+/* Charge the keyed time actually used (PTT on to PTT off) */
+void txgov_charge(uint32_t key_ms, uint32_t now);
+
+/* Time until key_ms would be allowed (0 = now, UINT32_MAX = larger than a
+ * bucket: allowed only with full buckets)
+ */
+uint32_t txgov_waitMs(uint32_t key_ms);
+
+const txgov_state_t *txgov_state(void);
+const txgov_cfg_t *txgov_cfg(void);
+
+#endif /* TXGOV_H */
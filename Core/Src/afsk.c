@@ -1,10 +1,14 @@
 /* afsk.c
- * AFSK1200 generator: bit-stuffing, NRZI, timer-driven sample output.
+ * AFSK/FSK generator: bit-stuffing, NRZI, timer-driven sample output.
+ * Baud, tones and sample rate come from the modem profile table.
  * VERSION 2 - Optimized DAC writes, verified logic for Direwolf compatibility
  */
 
 #include "afsk.h"
+#include "g3ruh.h"
 #include "main.h"
+#include "stats.h"
+#include "trace.h"
 #include <string.h>
 #include <stdint.h>
 
@@ -12,67 +16,158 @@
 #define AFSK_FIFO_SIZE  (8192)
 static volatile uint8_t afsk_fifo[AFSK_FIFO_SIZE];
 static volatile uint32_t fifo_head = 0, fifo_tail = 0, fifo_count = 0;
+/* Set once the body of this frame has lost bits to a full FIFO */
+static uint8_t fifo_short = 0;
+
+/* Bit sources the ISR plays in order: packed bit arrays (flag runs,
+ * pre-rendered frames), each repeated, or with bits == NULL the bit FIFO.
+ * A frame is preamble flags + body + tail flags.
+ */
+#define AFSK_MAX_SEGMENTS  4
+
+typedef struct {
+    const uint8_t *bits;    /* LSB first; NULL = FIFO */
+    uint32_t       nbits;
+    uint16_t       repeat;
+} afsk_segment_t;
+
+static afsk_segment_t segments[AFSK_MAX_SEGMENTS];
+static volatile uint8_t seg_count = 0, seg_index = 0;
+static volatile uint32_t seg_pos = 0;
+static volatile uint16_t seg_rep = 0;
+
+/* Preamble/tail fill, one byte replayed by reference: 0x7E LSB first, or
+ * the IL2P 0x55 sent MSB first (0xAA packed LSB first)
+ */
+static const uint8_t fill_hdlc = 0x7E;
+static const uint8_t fill_il2p = 0xAA;
+static uint16_t preamble_flags = AFSK_PREAMBLE_FLAGS;
+
+/* Render target: while set, bits are packed here instead of the FIFO */
+static afsk_stream_t *render_to = NULL;
 
 /* NRZI / sample state
  * CRITICAL: AX.25 idles at MARK (1200 Hz), so initial state must be 1
  */
 static volatile uint8_t nrzi_tone_state = 1;  /* 1 = MARK (1200 Hz) */
+/* Line code of the frame being played: IL2P is NRZ, the bit is the tone */
+static volatile uint8_t line_nrz = 0;
 static volatile uint8_t samples_left_for_bit = 0;
 static volatile uint8_t afsk_running = 0;
 
-/* 16-entry 4-bit sine table (values 0-15, centered at 8)
- * Standard symmetric sine lookup for AFSK
+/* 64-entry 4-bit sine table: round(8 + 7 sin), values 1-15, centered at 8.
+ * The DAC has only 16 levels, but the finer phase steps matter at the
+ * higher profiles: AFSK2400's space tone gets under 5 samples per cycle,
+ * and a 16-entry table would quantise its phase to 22.5 degrees.
  */
-static const uint8_t sine16[16] = {
-     8, 11, 13, 14, 15, 14, 13, 11,
-     8,  5,  2,  1,  0,  1,  2,  5
+static const uint8_t sine64[64] = {
+     8,  9,  9, 10, 11, 11, 12, 12, 13, 13, 14, 14, 14, 15, 15, 15,
+    15, 15, 15, 15, 14, 14, 14, 13, 13, 12, 12, 11, 11, 10,  9,  9,
+     8,  7,  7,  6,  5,  5,  4,  4,  3,  3,  2,  2,  2,  1,  1,  1,
+     1,  1,  1,  1,  2,  2,  2,  3,  3,  4,  4,  5,  5,  6,  7,  7
 };
 
-/* sample rate and tone parameters */
-#define SAMPLE_RATE  9600U
-#define BAUD         1200U
-#define SAMPLES_PER_BIT  (SAMPLE_RATE / BAUD)  /* = 8 */
-
 /* Phase accumulator (16-bit fixed point for precision) */
 static volatile uint16_t phase_acc = 0;
 
-/* Phase increments: one complete sine cycle = 4096 phase units (16 entries * 256)
- * Mark 1200 Hz: (1200 * 4096) / 9600 = 512
- * Space 2200 Hz: (2200 * 4096) / 9600 = 938.67 ≈ 939
+/* Phase increments: one complete sine cycle = 4096 phase units (64 entries * 64)
+ * e.g. Mark 1200 Hz @ 9600: (1200 * 4096) / 9600 = 512
+ *      Space 2200 Hz @ 9600: (2200 * 4096) / 9600 = 938.67 -> 939
+ * Rounded to nearest so every profile's table entry is computed at build time.
  */
-#define PHASE_INC_MARK   512
-#define PHASE_INC_SPACE  939   /* Slightly more accurate than 938 */
+#define PHASE_INC(f, fs)  ((uint16_t)((((uint32_t)(f) * 4096U) + ((fs) / 2U)) / (fs)))
+
+#define AFSK_PROFILE(nm, b, mark, space, fs) \
+    { nm, AFSK_KIND_AFSK, b, mark, space, fs, (uint8_t)((fs) / (b)), \
+      PHASE_INC(mark, fs), PHASE_INC(space, fs) }
+
+/* Modem profile table (indexed by afsk_profile_id_t) */
+static const afsk_profile_t profiles[AFSK_PROFILE_COUNT] = {
+    [AFSK_PROFILE_AFSK300]   = AFSK_PROFILE("AFSK300",  300,  1600, 1800,  9600U),
+    [AFSK_PROFILE_AFSK1200]  = AFSK_PROFILE("AFSK1200", 1200, 1200, 2200,  9600U),
+    [AFSK_PROFILE_AFSK2400]  = AFSK_PROFILE("AFSK2400", 2400, 2165, 3970, 19200U),
+    [AFSK_PROFILE_G3RUH9600] = { "G3RUH9600", AFSK_KIND_FSK, G3RUH_BAUD, 0, 0,
+                                 G3RUH_SAMPLE_RATE, G3RUH_SAMPLES_PER_BIT, 0, 0 },
+};
 
-static volatile uint16_t current_phase_inc = PHASE_INC_MARK;
+/* Active profile, plus ISR copies of its per-bit parameters */
+static const afsk_profile_t *profile = &profiles[AFSK_PROFILE_AFSK1200];
+static volatile uint8_t  samples_per_bit = 9600U / 1200U;
+static volatile uint16_t phase_inc_mark  = PHASE_INC(1200, 9600U);
+static volatile uint16_t phase_inc_space = PHASE_INC(2200, 9600U);
+
+static volatile uint16_t current_phase_inc = PHASE_INC(1200, 9600U);
+
+/* G3RUH state: scrambler LFSR and last 4 line bits for pulse shaping */
+static uint32_t g3ruh_lfsr = G3RUH_LFSR_INIT;
+static uint8_t g3ruh_history = 0;
 
 /* Bit stuffing counter - must be reset before each frame */
 static uint8_t consecutive_ones = 0;
 
-/* External DAC write function */
-extern void DAC_Write4(uint8_t v);
-
 /* Enqueue single bit into FIFO (called from main context only) */
 static int afsk_EnqueueBit(uint8_t bit)
 {
+    if (render_to) {
+        afsk_stream_t *r = render_to;
+        if (r->nbits >= (uint32_t)r->size * 8) {
+            r->overflow = 1;    /* dropped; afsk_render() reports it */
+            return 0;
+        }
+        if (bit & 1) r->bits[r->nbits >> 3] |= (uint8_t)(1U << (r->nbits & 7));
+        else r->bits[r->nbits >> 3] &= (uint8_t)~(1U << (r->nbits & 7));
+        r->nbits++;
+        return 0;
+    }
+
     if (fifo_count >= AFSK_FIFO_SIZE) {
+        /* The ISR will run dry before the end of the frame */
+        if (!fifo_short) stats_inc(STAT_UNDERRUNS);
+        fifo_short = 1;
         return -1;  /* full */
     }
     afsk_fifo[fifo_head] = (bit & 1);
     fifo_head = (fifo_head + 1) % AFSK_FIFO_SIZE;
     fifo_count++;
+    stats_peak(STAT_FIFO_PEAK, fifo_count);
     return 0;
 }
 
 /* Dequeue bit (called from ISR context only); returns -1 if empty */
-static int afsk_DequeueBit(void)
+RAMFUNC static int afsk_DequeueBit(void)
 {
-    if (fifo_count == 0) {
-        return -1;
+    while (seg_index < seg_count) {
+        const afsk_segment_t *sg = &segments[seg_index];
+
+        if (!sg->bits) {
+            if (fifo_count > 0) {
+                uint8_t val = afsk_fifo[fifo_tail];
+                fifo_tail = (fifo_tail + 1) % AFSK_FIFO_SIZE;
+                fifo_count--;
+                return val;
+            }
+        } else if (seg_pos < sg->nbits) {
+            uint32_t p = seg_pos++;
+            return (sg->bits[p >> 3] >> (p & 7)) & 1;
+        }
+
+        /* Segment pass done */
+        seg_pos = 0;
+        if (sg->bits && ++seg_rep < sg->repeat) continue;
+        seg_rep = 0;
+        seg_index++;
     }
-    uint8_t val = afsk_fifo[fifo_tail];
-    fifo_tail = (fifo_tail + 1) % AFSK_FIFO_SIZE;
-    fifo_count--;
-    return val;
+    return -1;
+}
+
+/* Queue a bit source for the ISR (main context, before afsk_start()) */
+static void afsk_AddSegment(const uint8_t *bits, uint32_t nbits, uint16_t repeat)
+{
+    if (seg_count >= AFSK_MAX_SEGMENTS || repeat == 0) return;
+    segments[seg_count].bits = bits;
+    segments[seg_count].nbits = nbits;
+    segments[seg_count].repeat = repeat;
+    seg_count++;
 }
 
 /* Initialize AFSK internals */
@@ -81,12 +176,47 @@ void afsk_Init(void)
     fifo_head = 0;
     fifo_tail = 0;
     fifo_count = 0;
+    seg_count = 0;
+    seg_index = 0;
+    seg_pos = 0;
+    seg_rep = 0;
     nrzi_tone_state = 1;       /* CRITICAL: Start at MARK (1200 Hz) */
     samples_left_for_bit = 0;
     afsk_running = 0;
     phase_acc = 0;
-    current_phase_inc = PHASE_INC_MARK;
+    current_phase_inc = phase_inc_mark;
     consecutive_ones = 0;
+    g3ruh_lfsr = G3RUH_LFSR_INIT;
+    g3ruh_history = 0;
+}
+
+void afsk_setProfile(afsk_profile_id_t id)
+{
+    if (afsk_isBusy() || id >= AFSK_PROFILE_COUNT) return;
+
+    profile = &profiles[id];
+    samples_per_bit = profile->samples_per_bit;
+    phase_inc_mark = profile->phase_inc_mark;
+    phase_inc_space = profile->phase_inc_space;
+    current_phase_inc = phase_inc_mark;
+}
+
+const afsk_profile_t *afsk_getProfile(void)
+{
+    return profile;
+}
+
+int afsk_findProfile(uint16_t baud)
+{
+    for (int i = 0; i < AFSK_PROFILE_COUNT; i++) {
+        if (profiles[i].baud == baud) return i;
+    }
+    return -1;
+}
+
+uint32_t afsk_getSampleRate(void)
+{
+    return profile->sample_rate;
 }
 
 /* Send a single byte as bits (LSB first), NO bit stuffing
@@ -129,27 +259,23 @@ static void send_byte_stuffed(uint8_t byte)
     }
 }
 
-/* afsk_generate:
- * Takes raw frame data (WITHOUT flags) and generates the complete
- * AFSK bit stream with preamble, bit stuffing, and tail flags.
- *
- * Frame format expected: [address fields][control][PID][payload][FCS]
- * This function adds: [preamble flags][frame with stuffing][tail flags]
- */
-void afsk_generate(const uint8_t *frame, uint16_t frame_len)
+/* CRITICAL: RESET ALL STATE BEFORE EACH TRANSMISSION */
+static void afsk_ResetTx(void)
 {
-    if (!frame || frame_len == 0) return;
-
-    /* ===== CRITICAL: RESET ALL STATE BEFORE EACH TRANSMISSION ===== */
-
-    /* Reset FIFO pointers */
+    /* Reset FIFO pointers and bit sources */
     fifo_head = 0;
     fifo_tail = 0;
     fifo_count = 0;
+    fifo_short = 0;
+    seg_count = 0;
+    seg_index = 0;
+    seg_pos = 0;
+    seg_rep = 0;
 
-    /* Reset NRZI state to MARK (1200 Hz) - AX.25 idle state */
+    /* Reset NRZI state to MARK - AX.25 idle state */
     nrzi_tone_state = 1;
-    current_phase_inc = PHASE_INC_MARK;
+    line_nrz = 0;
+    current_phase_inc = phase_inc_mark;
 
     /* Reset phase accumulator for clean waveform start */
     phase_acc = 0;
@@ -160,19 +286,30 @@ void afsk_generate(const uint8_t *frame, uint16_t frame_len)
     /* Reset bit stuffing counter */
     consecutive_ones = 0;
 
-    /* ===== BUILD THE BIT STREAM ===== */
+    /* Reset scrambler so every frame starts from a known state */
+    g3ruh_lfsr = G3RUH_LFSR_INIT;
+    g3ruh_history = 0;
+}
 
-    /* 1. PREAMBLE: Send flag bytes (0x7E) WITHOUT bit stuffing
-     *    50 flags = 400 bits = 333ms at 1200 baud
-     *    This gives receivers time to synchronize
-     */
-    for (int i = 0; i < 50; i++) {
-        send_byte_raw(0x7E);
-    }
+/* Queue preamble fill + body + tail fill. The fill is one shared byte
+ * replayed by the ISR, so the preamble costs nothing to build and its
+ * length can change per frame.
+ */
+static void afsk_QueueFrame(afsk_raw_t framing, const uint8_t *body, uint32_t nbits)
+{
+    const uint8_t *fill = (framing == AFSK_RAW_IL2P) ? &fill_il2p : &fill_hdlc;
 
-    /* 2. FRAME DATA: Send WITH bit stuffing
-     *    Skip any flags that might be in the input (defensive)
-     */
+    line_nrz = (framing == AFSK_RAW_IL2P);
+    afsk_AddSegment(fill, 8, preamble_flags);
+    afsk_AddSegment(body, nbits, 1);
+    afsk_AddSegment(fill, 8, AFSK_TAIL_FLAGS);
+}
+
+/* Frame body WITH bit stuffing
+ * Skip any flags that might be in the input (defensive)
+ */
+static void emit_hdlc(const uint8_t *frame, uint16_t frame_len)
+{
     uint16_t start = 0;
     uint16_t end = frame_len;
 
@@ -190,18 +327,129 @@ void afsk_generate(const uint8_t *frame, uint16_t frame_len)
     for (uint16_t i = start; i < end; i++) {
         send_byte_stuffed(frame[i]);
     }
+}
 
-    /* 3. TAIL: Send closing flag bytes WITHOUT bit stuffing
-     *    3 flags ensures clean frame termination
-     */
-    for (int i = 0; i < 3; i++) {
-        send_byte_raw(0x7E);
+/* afsk_generate:
+ * Takes raw frame data (WITHOUT flags) and generates the complete
+ * AFSK bit stream with preamble, bit stuffing, and tail flags.
+ *
+ * Frame format expected: [address fields][control][PID][payload][FCS]
+ * This function adds: [preamble flags][frame with stuffing][tail flags]
+ *
+ * PREAMBLE: flag bytes (0x7E) WITHOUT bit stuffing
+ *    50 flags = 400 bits = 333ms at 1200 baud (42ms at 9600)
+ *    This gives receivers time to synchronize (and, for G3RUH,
+ *    their descramblers time to lock)
+ * TAIL: 3 flags ensures clean frame termination
+ * Only the body goes through the FIFO; the flags are replayed.
+ */
+void afsk_generate(const uint8_t *frame, uint16_t frame_len)
+{
+    if (!frame || frame_len == 0) return;
+
+    afsk_ResetTx();
+    afsk_QueueFrame(AFSK_RAW_HDLC, NULL, 0);
+    emit_hdlc(frame, frame_len);
+}
+
+/* Send a single byte as bits MSB first, NO bit stuffing (IL2P) */
+static void send_byte_msb(uint8_t byte)
+{
+    for (int8_t i = 7; i >= 0; i--) {
+        uint8_t bit = (byte >> i) & 1;
+        while (afsk_EnqueueBit(bit) != 0) {
+            /* FIFO full */
+        }
+    }
+}
+
+static void emit_raw(const uint8_t *data, uint16_t len, afsk_raw_t framing)
+{
+    void (*send)(uint8_t) = (framing == AFSK_RAW_IL2P) ? send_byte_msb : send_byte_raw;
+
+    for (uint16_t i = 0; i < len; i++) {
+        send(data[i]);
+    }
+}
+
+/* afsk_generateRaw:
+ * Preamble and tail like afsk_generate(), but the body is sent as-is
+ * (no bit stuffing). Used for FEC-framed data whose framing is already
+ * inside the encoded block:
+ *   AFSK_RAW_HDLC: 0x7E flags, LSB first (FX.25)
+ *   AFSK_RAW_IL2P: 0x55 bytes, MSB first (IL2P)
+ */
+void afsk_generateRaw(const uint8_t *data, uint16_t len, afsk_raw_t framing)
+{
+    if (!data || len == 0) return;
+
+    afsk_ResetTx();
+    afsk_QueueFrame(framing, NULL, 0);
+    emit_raw(data, len, framing);
+}
+
+/* Render into a stream instead of the FIFO. Stuffing state is shared with
+ * the FIFO path, so this must not run while a frame is being generated
+ * (the ISR may be playing one).
+ */
+static int render_begin(afsk_stream_t *s, afsk_raw_t framing)
+{
+    if (!s || !s->bits || s->size == 0) return -1;
+    s->nbits = 0;
+    s->overflow = 0;
+    s->framing = framing;
+    consecutive_ones = 0;
+    render_to = s;
+    return 0;
+}
+
+static int render_end(afsk_stream_t *s)
+{
+    render_to = NULL;
+    consecutive_ones = 0;
+    if (s->overflow) {
+        s->nbits = 0;
+        return -1;
     }
+    return 0;
+}
+
+int afsk_render(const uint8_t *frame, uint16_t frame_len, afsk_stream_t *s)
+{
+    if (!frame || frame_len == 0 || render_begin(s, AFSK_RAW_HDLC) != 0) return -1;
+    emit_hdlc(frame, frame_len);
+    return render_end(s);
+}
+
+int afsk_renderRaw(const uint8_t *data, uint16_t len, afsk_raw_t framing, afsk_stream_t *s)
+{
+    if (!data || len == 0 || render_begin(s, framing) != 0) return -1;
+    emit_raw(data, len, framing);
+    return render_end(s);
+}
+
+void afsk_play(const afsk_stream_t *s)
+{
+    if (!s || s->nbits == 0) return;
+
+    afsk_ResetTx();
+    afsk_QueueFrame(s->framing, s->bits, s->nbits);
+}
+
+void afsk_setPreambleFlags(uint16_t flags)
+{
+    preamble_flags = flags ? flags : 1;
+}
+
+uint16_t afsk_getPreambleFlags(void)
+{
+    return preamble_flags;
 }
 
 /* Start AFSK transmission */
 void afsk_start(void)
 {
+    trace_event(TRACE_FRAME_START, 0);
     afsk_running = 1;
 }
 
@@ -212,18 +460,55 @@ void afsk_stop(void)
     DAC_Write4(8);  /* Return to mid-level (DC bias point) */
 }
 
+/* G3RUH sample path: NRZI (NRZ for IL2P) -> scrambler -> shaped pulse table.
+ * Same FIFO and line coding as AFSK, the line level replaces the tone.
+ */
+RAMFUNC static void g3ruh_tick(void)
+{
+    if (samples_left_for_bit == 0) {
+        int nextbit = afsk_DequeueBit();
+
+        if (nextbit < 0) {
+            DAC_Write4(8);
+            afsk_running = 0;
+            trace_event(TRACE_FRAME_END, 0);
+            return;
+        }
+
+        if (line_nrz) {
+            nrzi_tone_state = (uint8_t)nextbit;
+        } else if (nextbit == 0) {
+            nrzi_tone_state = !nrzi_tone_state;
+        }
+
+        uint8_t line = g3ruh_scramble(&g3ruh_lfsr, nrzi_tone_state);
+        g3ruh_history = (uint8_t)(((g3ruh_history << 1) | line) & 0x0F);
+
+        samples_left_for_bit = G3RUH_SAMPLES_PER_BIT;
+    }
+
+    DAC_Write4(g3ruh_pulse[g3ruh_history][G3RUH_SAMPLES_PER_BIT - samples_left_for_bit]);
+    samples_left_for_bit--;
+}
+
 /* afsk_timer_tick:
- * Called at SAMPLE_RATE (9600 Hz) from timer ISR.
+ * Called at afsk_getSampleRate() from timer ISR.
  * Produces one 4-bit DAC sample per call.
  * Implements NRZI encoding: 0 bit = toggle tone, 1 bit = same tone
+ * (IL2P frames are NRZ: 1 bit = MARK, 0 bit = SPACE)
  */
-void afsk_timer_tick(void)
+RAMFUNC void afsk_timer_tick(void)
 {
     if (!afsk_running) {
         DAC_Write4(8);  /* Mid-level when idle */
         return;
     }
 
+    if (profile->kind == AFSK_KIND_FSK) {
+        g3ruh_tick();
+        return;
+    }
+
     /* Check if we need a new bit */
     if (samples_left_for_bit == 0) {
         int nextbit = afsk_DequeueBit();
@@ -232,6 +517,7 @@ void afsk_timer_tick(void)
             /* No more bits - transmission complete */
             DAC_Write4(8);
             afsk_running = 0;
+            trace_event(TRACE_FRAME_END, 0);
             return;
         }
 
@@ -241,24 +527,28 @@ void afsk_timer_tick(void)
          *
          * This means continuous 1s = continuous MARK tone
          * Flag 0x7E (01111110) produces the characteristic warble
+         *
+         * IL2P is NRZ: the bit selects the tone directly
          */
-        if (nextbit == 0) {
+        if (line_nrz) {
+            nrzi_tone_state = (uint8_t)nextbit;
+        } else if (nextbit == 0) {
             nrzi_tone_state = !nrzi_tone_state;
         }
         /* else: bit is 1, keep same tone */
 
         /* Update phase increment for the (possibly new) tone */
-        current_phase_inc = nrzi_tone_state ? PHASE_INC_MARK : PHASE_INC_SPACE;
+        current_phase_inc = nrzi_tone_state ? phase_inc_mark : phase_inc_space;
 
         /* Reset sample counter for this bit */
-        samples_left_for_bit = SAMPLES_PER_BIT;
+        samples_left_for_bit = samples_per_bit;
     }
 
     /* Generate sine wave sample using DDS (Direct Digital Synthesis)
-     * phase_acc upper 4 bits (bits 8-11) index into 16-entry sine table
+     * phase_acc bits 6-11 index into the 64-entry sine table
      */
-    uint8_t table_index = (phase_acc >> 8) & 0x0F;
-    DAC_Write4(sine16[table_index]);
+    uint8_t table_index = (phase_acc >> 6) & 0x3F;
+    DAC_Write4(sine64[table_index]);
 
     /* Advance phase accumulator
      * This maintains phase continuity when switching tones
@@ -271,11 +561,23 @@ void afsk_timer_tick(void)
 /* Check if transmission is still in progress */
 uint8_t afsk_isBusy(void)
 {
-    return afsk_running || (fifo_count > 0);
+    return afsk_running || (fifo_count > 0) || (seg_index < seg_count);
 }
 
-/* Get number of bits remaining in FIFO (for debugging) */
+uint8_t afsk_isRunning(void)
+{
+    return afsk_running;
+}
+
+/* Get number of bits still to be sent (for debugging) */
 uint32_t afsk_getBitsRemaining(void)
 {
-    return fifo_count;
+    uint32_t n = fifo_count;
+    for (uint8_t i = seg_index; i < seg_count; i++) {
+        const afsk_segment_t *sg = &segments[i];
+        if (!sg->bits) continue;
+        n += sg->nbits * sg->repeat;
+        if (i == seg_index) n -= seg_rep * sg->nbits + seg_pos;
+    }
+    return n;
 }
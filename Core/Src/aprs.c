@@ -1,6 +1,7 @@
 #include "aprs.h"
 #include "ax25.h"
 #include <string.h>
+#include <stdio.h>
 
 /* Definitions */
 char src_call[10]   = "ORBITR";
@@ -53,3 +54,258 @@ void APRS_Send(const char *msg) {
     /* AX25_EndFrame enqueues CRC, flags into bit FIFO and starts modulation.
        APRS_Send returns immediately, but user code waits by checking AFSK_isBusy() */
 }
+
+/* ================= TELEMETRY ================= */
+
+static uint16_t tlm_reports = 0;
+static int8_t tlm_def_next = -1;
+
+void APRS_Base91(char *out, uint32_t value, uint8_t width)
+{
+    for (int i = width - 1; i >= 0; i--) {
+        out[i] = (char)(33 + value % 91);
+        value /= 91;
+    }
+}
+
+int APRS_FormatTelemetry(char *out, size_t size, uint16_t seq,
+                         const uint8_t analog[APRS_TLM_ANALOG], uint8_t digital)
+{
+    char bits[APRS_TLM_DIGITAL + 1];
+    for (int i = 0; i < APRS_TLM_DIGITAL; i++) {
+        bits[i] = (digital & (1U << i)) ? '1' : '0';
+    }
+    bits[APRS_TLM_DIGITAL] = 0;
+
+    int n = snprintf(out, size, "T#%03u,%03u,%03u,%03u,%03u,%03u,%s",
+                     seq % 1000, analog[0], analog[1], analog[2], analog[3], analog[4], bits);
+    return (n < 0 || (size_t)n >= size) ? -1 : n;
+}
+
+int APRS_FormatCompressedTelemetry(char *out, size_t size, uint16_t seq,
+                                   const uint16_t *analog, uint8_t n_analog,
+                                   uint8_t with_digital, uint8_t digital)
+{
+    if (n_analog < 1 || n_analog > APRS_TLM_ANALOG) return -1;
+
+    size_t len = 2 + 2 + 2 * (size_t)n_analog + (with_digital ? 2 : 0);
+    if (len + 1 > size) return -1;
+
+    char *p = out;
+    *p++ = '|';
+    APRS_Base91(p, seq % (APRS_TLM_B91_MAX + 1), 2);
+    p += 2;
+    for (uint8_t i = 0; i < n_analog; i++) {
+        APRS_Base91(p, analog[i] > APRS_TLM_B91_MAX ? APRS_TLM_B91_MAX : analog[i], 2);
+        p += 2;
+    }
+    if (with_digital) {
+        APRS_Base91(p, digital, 2);
+        p += 2;
+    }
+    *p++ = '|';
+    *p = 0;
+    return (int)len;
+}
+
+int APRS_FormatTelemetryDef(char *out, size_t size, const char *call, uint8_t ssid,
+                            aprs_tlm_def_t which, const aprs_tlm_defs_t *defs)
+{
+    static const char *const tag[APRS_TLM_DEF_COUNT] = { "PARM.", "UNIT.", "EQNS.", "BITS." };
+    char addressee[16];
+
+    if (which >= APRS_TLM_DEF_COUNT || !defs) return -1;
+
+    /* Addressee is padded to 9 characters */
+    if (ssid) snprintf(addressee, sizeof(addressee), "%s-%u", call, ssid);
+    else snprintf(addressee, sizeof(addressee), "%s", call);
+
+    int n = snprintf(out, size, ":%-9.9s:%s", addressee, tag[which]);
+    if (n < 0 || (size_t)n >= size) return -1;
+
+    if (which == APRS_TLM_BITS) {
+        for (int i = 0; i < APRS_TLM_DIGITAL; i++) {
+            n += snprintf(out + n, size - (size_t)n, "%c",
+                          (defs->bits_sense & (1U << i)) ? '1' : '0');
+            if ((size_t)n >= size) return -1;
+        }
+        n += snprintf(out + n, size - (size_t)n, ",%s", defs->title ? defs->title : "");
+        if ((size_t)n >= size) return -1;
+        return n;
+    }
+
+    uint8_t count = (which == APRS_TLM_EQNS) ? APRS_TLM_ANALOG : APRS_TLM_CHANNELS;
+    const char *const *item = (which == APRS_TLM_PARM) ? defs->name :
+                              (which == APRS_TLM_UNIT) ? defs->unit : defs->eqns;
+
+    /* Trailing unused channels are left out */
+    while (count > 0 && !item[count - 1]) count--;
+
+    for (uint8_t i = 0; i < count; i++) {
+        n += snprintf(out + n, size - (size_t)n, "%s%s", i ? "," : "",
+                      item[i] ? item[i] : (which == APRS_TLM_EQNS ? "0,1,0" : ""));
+        if ((size_t)n >= size) return -1;
+    }
+    return n;
+}
+
+int APRS_NextTelemetryDef(void)
+{
+    if (tlm_def_next >= 0) {
+        int d = tlm_def_next++;
+        if (tlm_def_next >= APRS_TLM_DEF_COUNT) tlm_def_next = -1;
+        return d;
+    }
+
+    /* Definitions go out first after boot, then every APRS_TLM_DEF_EVERY */
+    if (tlm_reports++ % APRS_TLM_DEF_EVERY == 0) {
+        tlm_def_next = 1;
+        return APRS_TLM_PARM;
+    }
+    return -1;
+}
+
+/* ================= POSITION ================= */
+
+#define APRS_UDEG_LAT_MAX   90000000L
+#define APRS_UDEG_LON_MAX   180000000L
+/* Mic-E longitude degrees stop at 179: 180 would encode as 100 */
+#define APRS_MICE_HMIN_MAX  (179U * 6000U + 5999U)
+
+/* Compressed position scales (380926 and 190463 per degree) as Q32
+ * fractions per microdegree, so scaling is one 32x32->64 multiply
+ */
+#define APRS_CP_LAT_Q32     1636064713ULL   /* 0.380926 * 2^32, rounded up */
+#define APRS_CP_LON_Q32     818032357ULL    /* 0.190463 * 2^32, rounded up */
+
+static uint32_t clamp_abs(int32_t v, int32_t max)
+{
+    if (v > max) v = max;
+    if (v < -max) v = -max;
+    return (uint32_t)(v < 0 ? -v : v);
+}
+
+/* |microdegrees| -> hundredths of a minute, rounded */
+static uint32_t udeg_to_hmin(uint32_t udeg)
+{
+    return (udeg * 6U + 500U) / 1000U;
+}
+
+int APRS_FormatMicE(char dest[7], char *out, size_t size, const aprs_pos_t *pos,
+                    aprs_mice_msg_t msg, const char *comment)
+{
+    if (!dest || !out || !pos || (unsigned)msg > APRS_MICE_OFF_DUTY) return -1;
+
+    uint32_t lat = udeg_to_hmin(clamp_abs(pos->lat, APRS_UDEG_LAT_MAX));
+    uint32_t lon = udeg_to_hmin(clamp_abs(pos->lon, APRS_UDEG_LON_MAX));
+    if (lon > APRS_MICE_HMIN_MAX) lon = APRS_MICE_HMIN_MAX;
+    uint32_t lon_deg = lon / 6000U;
+    uint32_t lon_min = (lon / 100U) % 60U;
+    uint8_t offset = (lon_deg < 10U || lon_deg >= 100U);
+
+    /* Destination: six latitude digits DDMMhh, flag per character */
+    uint32_t d = lat / 6000U * 10000U + (lat / 100U) % 60U * 100U + lat % 100U;
+    uint8_t flag[6] = {
+        (uint8_t)((msg >> 2) & 1U), (uint8_t)((msg >> 1) & 1U), (uint8_t)(msg & 1U),
+        (uint8_t)(pos->lat >= 0), offset, (uint8_t)(pos->lon < 0),
+    };
+    for (int i = 5; i >= 0; i--) {
+        dest[i] = (char)((flag[i] ? 'P' : '0') + d % 10U);
+        d /= 10U;
+    }
+    dest[6] = 0;
+
+    uint16_t speed = pos->speed > 799U ? 799U : pos->speed;
+    uint16_t course = pos->course > 360U ? 360U : pos->course;
+    uint8_t sp = (uint8_t)(speed / 10U);
+    size_t len = 9 + (pos->has_alt ? 4 : 0) + (comment ? strlen(comment) : 0);
+    if (len + 1 > size) return -1;
+
+    char *p = out;
+    *p++ = '`';
+    if (lon_deg < 10U) *p++ = (char)(lon_deg + 118U);
+    else if (lon_deg < 100U) *p++ = (char)(lon_deg + 28U);
+    else if (lon_deg < 110U) *p++ = (char)(lon_deg + 8U);
+    else *p++ = (char)(lon_deg - 72U);
+    *p++ = (char)(lon_min < 10U ? lon_min + 88U : lon_min + 28U);
+    *p++ = (char)(lon % 100U + 28U);
+    /* Speed +800 and course +400 keep these two out of the control range;
+     * receivers take both modulo
+     */
+    *p++ = (char)(sp < 20U ? sp + 108U : sp + 28U);
+    *p++ = (char)((speed % 10U) * 10U + course / 100U + 32U);
+    *p++ = (char)(course % 100U + 28U);
+    *p++ = pos->symbol;
+    *p++ = pos->table;
+
+    if (pos->has_alt) {
+        /* Metres above -10 km, three base91 digits */
+        int32_t a = pos->alt + 10000;
+        if (a < 0) a = 0;
+        if (a > 91 * 91 * 91 - 1) a = 91 * 91 * 91 - 1;
+        APRS_Base91(p, (uint32_t)a, 3);
+        p += 3;
+        *p++ = '}';
+    }
+    if (comment) {
+        memcpy(p, comment, strlen(comment));
+        p += strlen(comment);
+    }
+    *p = 0;
+    return (int)len;
+}
+
+int APRS_FormatCompressedPosition(char *out, size_t size, const aprs_pos_t *pos,
+                                  const char *comment)
+{
+    if (!out || !pos) return -1;
+
+    size_t len = 14 + (comment ? strlen(comment) : 0);
+    if (len + 1 > size) return -1;
+
+    int32_t lat = pos->lat > APRS_UDEG_LAT_MAX ? APRS_UDEG_LAT_MAX :
+                  pos->lat < -APRS_UDEG_LAT_MAX ? -APRS_UDEG_LAT_MAX : pos->lat;
+    int32_t lon = pos->lon > APRS_UDEG_LON_MAX ? APRS_UDEG_LON_MAX :
+                  pos->lon < -APRS_UDEG_LON_MAX ? -APRS_UDEG_LON_MAX : pos->lon;
+    /* y = 380926 * (90 - lat), x = 190463 * (180 + lon), in degrees,
+     * truncated as in the spec examples
+     */
+    uint32_t y = (uint32_t)(((uint64_t)(uint32_t)(APRS_UDEG_LAT_MAX - lat) * APRS_CP_LAT_Q32) >> 32);
+    uint32_t x = (uint32_t)(((uint64_t)(uint32_t)(APRS_UDEG_LON_MAX + lon) * APRS_CP_LON_Q32) >> 32);
+
+    char *p = out;
+    *p++ = '!';
+    *p++ = pos->table;
+    APRS_Base91(p, y, 4);
+    p += 4;
+    APRS_Base91(p, x, 4);
+    p += 4;
+    *p++ = pos->symbol;
+
+    if (pos->course == 0 && pos->speed == 0) {
+        /* c = ' ': csT ignored */
+        *p++ = ' ';
+        *p++ = ' ';
+        *p++ = ' ';
+    } else {
+        /* s = log1.08(speed + 1), rounded: step 1.08^(s + 0.5) in Q16
+         * until it passes speed + 1
+         */
+        uint32_t target = ((uint32_t)(pos->speed > 900U ? 900U : pos->speed) + 1U) << 16;
+        uint32_t step = 68107U;     /* sqrt(1.08) * 2^16 */
+        uint8_t s = 0;
+        while (s < 89U && step <= target) {
+            step += step * 2U / 25U;
+            s++;
+        }
+        *p++ = (char)(33 + (pos->course % 360U) / 4U);
+        *p++ = (char)(33 + s);
+        *p++ = (char)(33 + 0x22);   /* T: current fix, software origin */
+    }
+    if (comment) {
+        memcpy(p, comment, strlen(comment));
+        p += strlen(comment);
+    }
+    *p = 0;
+    return (int)len;
+}
@@ -46,6 +46,30 @@ static uint16_t crc_ccitt_update(uint16_t crc, uint8_t data)
     return crc;
 }
 
+uint16_t ax25_fcs(const uint8_t *data, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < len; ++i) {
+        crc = crc_ccitt_update(crc, data[i]);
+    }
+    return (uint16_t)~crc;
+}
+
+/* Unpack one shifted address field into a NUL-terminated callsign.
+ * Returns the extension (last address) bit.
+ */
+static uint8_t read_callsign(const uint8_t *buf, char *call, uint8_t *ssid)
+{
+    uint8_t n = 0;
+    for (int i = 0; i < 6; ++i) {
+        char c = (char)(buf[i] >> 1);
+        if (c != ' ') call[n++] = c;
+    }
+    call[n] = 0;
+    *ssid = (buf[6] >> 1) & 0x0F;
+    return buf[6] & 0x01;
+}
+
 void ax25_encode(uint8_t *out, uint16_t *len,
                  const char *src, uint8_t src_ssid,
                  const char *dst, uint8_t dst_ssid,
@@ -95,11 +119,7 @@ void ax25_encode(uint8_t *out, uint16_t *len,
     }
 
     /* Compute CRC over all data so far */
-    uint16_t crc = 0xFFFF;
-    for (uint16_t i = 0; i < idx; ++i) {
-        crc = crc_ccitt_update(crc, out[i]);
-    }
-    crc = ~crc;
+    uint16_t crc = ax25_fcs(out, idx);
 
     /* Append FCS (LSB first) */
     out[idx++] = (uint8_t)(crc & 0xFF);
@@ -109,3 +129,38 @@ void ax25_encode(uint8_t *out, uint16_t *len,
 
     *len = idx;
 }
+
+int ax25_decode(const uint8_t *frame, uint16_t len, ax25_frame_t *out)
+{
+    if (!frame || !out || len < AX25_MIN_FRAME_LEN) return -1;
+
+    uint16_t body = len - AX25_FCS_LEN;
+    uint16_t fcs = (uint16_t)(frame[body] | (frame[body + 1] << 8));
+    if (ax25_fcs(frame, body) != fcs) return -1;
+
+    uint16_t idx = 0;
+    memset(out, 0, sizeof(*out));
+
+    if (read_callsign(&frame[idx], out->dst, &out->dst_ssid)) return -1;
+    idx += AX25_ADDR_LEN;
+
+    uint8_t last = read_callsign(&frame[idx], out->src, &out->src_ssid);
+    idx += AX25_ADDR_LEN;
+
+    while (!last) {
+        if (out->path_count >= AX25_MAX_REPEATERS) return -1;
+        if (idx + AX25_ADDR_LEN + 2 > body) return -1;
+        last = read_callsign(&frame[idx], out->path[out->path_count],
+                             &out->path_ssid[out->path_count]);
+        out->path_count++;
+        idx += AX25_ADDR_LEN;
+    }
+
+    if (idx + 2 > body) return -1;
+    out->control = frame[idx++];
+    out->pid = frame[idx++];
+
+    out->info = &frame[idx];
+    out->info_len = body - idx;
+    return 0;
+}
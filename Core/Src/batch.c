@@ -0,0 +1,55 @@
+/* batch.c
+ * Packs several RS485 telemetry lines into one APRS status payload, so the
+ * address header, FCS and preamble are paid once per batch.
+ */
+
+#include "batch.h"
+#include <string.h>
+
+void batch_Init(batch_t *b, const char *prefix, const char *suffix)
+{
+    b->prefix = prefix;
+    b->suffix = suffix;
+    batch_clear(b);
+}
+
+void batch_clear(batch_t *b)
+{
+    size_t n = strlen(b->prefix);
+    memcpy(b->buf, b->prefix, n);
+    b->buf[n] = 0;
+    b->len = (uint16_t)n;
+    b->count = 0;
+}
+
+int batch_add(batch_t *b, const char *line, uint32_t now)
+{
+    size_t room = BATCH_MAX_PAYLOAD - strlen(b->suffix) - b->len;
+    size_t n = strlen(line);
+    size_t need = n + (b->count ? 1 : 0);
+
+    if (need > room) {
+        if (b->count) return -1;
+        n = room;
+    }
+
+    if (b->count) b->buf[b->len++] = BATCH_SEPARATOR;
+    else b->first_tick = now;
+
+    memcpy(&b->buf[b->len], line, n);
+    b->len += (uint16_t)n;
+    b->buf[b->len] = 0;
+    b->count++;
+    return 0;
+}
+
+uint8_t batch_due(const batch_t *b, uint32_t now, uint32_t window_ms)
+{
+    return b->count && (now - b->first_tick) >= window_ms;
+}
+
+const char *batch_payload(batch_t *b)
+{
+    strcpy(&b->buf[b->len], b->suffix);
+    return b->buf;
+}
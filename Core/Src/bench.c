@@ -0,0 +1,75 @@
+/* bench.c
+ * On-target encoder benchmarks (DWT cycle counts)
+ */
+
+#include "bench.h"
+#include "afsk.h"
+#include "ax25.h"
+#include "dwt.h"
+#include "fx25.h"
+#include "il2p.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_RUNS  16
+
+static const char bench_payload[] =
+    ">BATT=7.41,TEMP=21,MODE=NOMINAL,SEQ=1234 | Somaiya OrbitRadio-5 73";
+
+static uint8_t frame[320];
+static uint8_t coded[IL2P_MAX_OUT(320)];
+
+static void report(void (*print)(const char *s), const char *name,
+                   uint32_t cycles, uint32_t bits)
+{
+    char buf[80];
+    snprintf(buf, sizeof(buf), "  %-10s %7lu cycles/frame  %5lu bits on air\r\n",
+             name, cycles / BENCH_RUNS, bits);
+    print(buf);
+}
+
+void bench_Framing(void (*print)(const char *s))
+{
+    uint16_t len = 0, n = 0;
+    uint32_t t0, cyc, bits;
+
+    if (afsk_isBusy()) return;
+    dwt_Init();
+
+    print("Framing benchmark (encode + enqueue):\r\n");
+
+    /* AX.25 UI frame + bit stuffing */
+    t0 = dwt_cycles();
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        ax25_encode(frame, &len, "VU3LTQ", 5, "VU2CWN", 0, NULL, 0, NULL, 0, bench_payload);
+        afsk_generate(frame, len);
+    }
+    cyc = dwt_cycles() - t0;
+    bits = afsk_getBitsRemaining();
+    report(print, "AX.25", cyc, bits);
+
+    /* FX.25, 16 check bytes */
+    t0 = dwt_cycles();
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        ax25_encode(frame, &len, "VU3LTQ", 5, "VU2CWN", 0, NULL, 0, NULL, 0, bench_payload);
+        n = fx25_encode(frame, len, 16, coded);
+        afsk_generateRaw(coded, n, AFSK_RAW_HDLC);
+    }
+    cyc = dwt_cycles() - t0;
+    bits = afsk_getBitsRemaining();
+    report(print, "FX.25/16", cyc, bits);
+
+    /* IL2P, max FEC */
+    t0 = dwt_cycles();
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        ax25_encode(frame, &len, "VU3LTQ", 5, "VU2CWN", 0, NULL, 0, NULL, 0, bench_payload);
+        n = il2p_encode(frame, len, coded, sizeof(coded));
+        afsk_generateRaw(coded, n, AFSK_RAW_IL2P);
+    }
+    cyc = dwt_cycles() - t0;
+    bits = afsk_getBitsRemaining();
+    report(print, "IL2P", cyc, bits);
+
+    /* Leave the modulator idle */
+    afsk_Init();
+}
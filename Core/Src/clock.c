@@ -0,0 +1,111 @@
+/* clock.c
+ * Core clock profiles
+ *
+ * The PLL is only reconfigured while the core runs from HSI, and the
+ * regulator scale only changes while the PLL is off, as RM0390 requires.
+ */
+
+#include "clock.h"
+#include "main.h"
+
+/* HSI without the PLL: APB at HCLK, no wait states */
+#define CLOCK_HSI(nm, hz, ahb, vos) \
+    { nm, hz, 0, 0, 0, 0, 0, 0, ahb, RCC_HCLK_DIV1, RCC_HCLK_DIV1, FLASH_LATENCY_0, vos, 0 }
+
+static const clock_profile_t profiles[CLOCK_PROFILE_COUNT] = {
+    [CLOCK_PROFILE_LP8]    = CLOCK_HSI("LP8",   8000000U, RCC_SYSCLK_DIV2, PWR_REGULATOR_VOLTAGE_SCALE3),
+    [CLOCK_PROFILE_HSI16]  = CLOCK_HSI("HSI16", 16000000U, RCC_SYSCLK_DIV1, PWR_REGULATOR_VOLTAGE_SCALE2),
+    /* 16 MHz / 8 * 180 / 2; PCLK1 45 MHz (TIM3 90 MHz), PCLK2 90 MHz, 5 WS */
+    [CLOCK_PROFILE_PLL180] = { "PLL180", 180000000U, 1, 8, 2, 8, 2, 180,
+                               RCC_SYSCLK_DIV1, RCC_HCLK_DIV4, RCC_HCLK_DIV2,
+                               FLASH_LATENCY_5, PWR_REGULATOR_VOLTAGE_SCALE1, 1 },
+};
+
+static clock_profile_id_t current = CLOCK_PROFILE_HSI16;
+
+/* SYSCLK back to plain HSI, PLL and over-drive off */
+static void clock_LeavePll(void)
+{
+    RCC_OscInitTypeDef osc = {0};
+    RCC_ClkInitTypeDef clk = {0};
+
+    if (__HAL_RCC_GET_SYSCLK_SOURCE() == RCC_SYSCLKSOURCE_STATUS_PLLCLK) {
+        clk.ClockType = RCC_CLOCKTYPE_SYSCLK|RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+        clk.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+        clk.AHBCLKDivider = RCC_SYSCLK_DIV1;
+        clk.APB1CLKDivider = RCC_HCLK_DIV1;
+        clk.APB2CLKDivider = RCC_HCLK_DIV1;
+        HAL_RCC_ClockConfig(&clk, FLASH_LATENCY_0);
+    }
+    if (__HAL_PWR_GET_FLAG(PWR_FLAG_ODRDY)) {
+        HAL_PWREx_DisableOverDrive();
+    }
+
+    osc.OscillatorType = RCC_OSCILLATORTYPE_HSI;
+    osc.HSIState = RCC_HSI_ON;
+    osc.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
+    osc.PLL.PLLState = RCC_PLL_OFF;
+    HAL_RCC_OscConfig(&osc);
+}
+
+int clock_setProfile(clock_profile_id_t id)
+{
+    if (id >= CLOCK_PROFILE_COUNT) return -1;
+
+    const clock_profile_t *p = &profiles[id];
+    RCC_OscInitTypeDef osc = {0};
+    RCC_ClkInitTypeDef clk = {0};
+
+    __HAL_RCC_PWR_CLK_ENABLE();
+    clock_LeavePll();
+    __HAL_PWR_VOLTAGESCALING_CONFIG(p->vos);
+
+    if (p->pll) {
+        osc.OscillatorType = RCC_OSCILLATORTYPE_HSI;
+        osc.HSIState = RCC_HSI_ON;
+        osc.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
+        osc.PLL.PLLState = RCC_PLL_ON;
+        osc.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+        osc.PLL.PLLM = p->pll_m;
+        osc.PLL.PLLN = p->pll_n;
+        osc.PLL.PLLP = p->pll_p;
+        osc.PLL.PLLQ = p->pll_q;
+        osc.PLL.PLLR = p->pll_r;
+        if (HAL_RCC_OscConfig(&osc) != HAL_OK ||
+            (p->overdrive && HAL_PWREx_EnableOverDrive() != HAL_OK)) {
+            clock_setProfile(CLOCK_PROFILE_HSI16);
+            return -1;
+        }
+    }
+
+    clk.ClockType = RCC_CLOCKTYPE_SYSCLK|RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
+    clk.SYSCLKSource = p->pll ? RCC_SYSCLKSOURCE_PLLCLK : RCC_SYSCLKSOURCE_HSI;
+    clk.AHBCLKDivider = p->ahb_div;
+    clk.APB1CLKDivider = p->apb1_div;
+    clk.APB2CLKDivider = p->apb2_div;
+    if (HAL_RCC_ClockConfig(&clk, p->flash_latency) != HAL_OK) {
+        if (id != CLOCK_PROFILE_HSI16) clock_setProfile(CLOCK_PROFILE_HSI16);
+        return -1;
+    }
+
+    current = id;
+    return 0;
+}
+
+clock_profile_id_t clock_getProfile(void)
+{
+    return current;
+}
+
+const clock_profile_t *clock_profileInfo(clock_profile_id_t id)
+{
+    return (id < CLOCK_PROFILE_COUNT) ? &profiles[id] : NULL;
+}
+
+int clock_findProfile(uint32_t mhz)
+{
+    for (int i = 0; i < CLOCK_PROFILE_COUNT; i++) {
+        if (profiles[i].hclk_hz == mhz * 1000000U) return i;
+    }
+    return -1;
+}
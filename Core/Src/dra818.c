@@ -0,0 +1,252 @@
+/* dra818.c
+ * DRA818U AT-command driver
+ *
+ * One command is in flight at a time. It is sent by interrupt, and the
+ * reply lines ("+DMOSETGROUP:0", "...:1" on error) are collected from the
+ * USART6 receive interrupt into a small ring and parsed in dra_Poll().
+ * A missing or negative reply resends the command after DRA_REPLY_MS.
+ */
+
+#include "dra818.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DRA_RX_RING   64U
+#define DRA_LINE_MAX  48U
+
+typedef enum {
+    DRA_CMD_CONNECT = 0,
+    DRA_CMD_GROUP,
+    DRA_CMD_VOLUME,
+    DRA_CMD_FILTER,
+    DRA_CMD_COUNT
+} dra_cmd_t;
+
+/* Reply prefix of each command; the value after ':' is 0 on success */
+static const struct {
+    const char *name;
+    const char *reply;
+} cmds[DRA_CMD_COUNT] = {
+    [DRA_CMD_CONNECT] = { "connect", "+DMOCONNECT:" },
+    [DRA_CMD_GROUP]   = { "group",   "+DMOSETGROUP:" },
+    [DRA_CMD_VOLUME]  = { "volume",  "+DMOSETVOLUME:" },
+    [DRA_CMD_FILTER]  = { "filter",  "+DMOSETFILTER:" },
+};
+
+typedef struct {
+    dra_cmd_t   cmd;
+    uint16_t    len;
+    char        text[DRA_CMD_MAX];      /* with "\r\n" */
+    dra_group_t group;                  /* DRA_CMD_GROUP */
+} dra_entry_t;
+
+static UART_HandleTypeDef *dra_uart;
+static dra_entry_t queue[DRA_QUEUE];
+static uint8_t q_head, q_count;
+static uint8_t in_flight;               /* queue[q_head] sent, reply pending */
+static uint8_t tries;
+static uint32_t sent_tick, first_tick;
+static char tx_buf[DRA_CMD_MAX];
+
+static uint8_t rx_byte;
+static volatile uint8_t rx_ring[DRA_RX_RING];
+static volatile uint8_t rx_head;
+static uint8_t rx_tail;
+static char line[DRA_LINE_MAX];
+static uint8_t line_len;
+
+static dra_result_t result;
+static dra_group_t group;
+
+void dra_Init(UART_HandleTypeDef *huart)
+{
+    dra_uart = huart;
+    q_head = q_count = 0;
+    in_flight = 0;
+    rx_head = rx_tail = 0;
+    line_len = 0;
+    HAL_UART_Receive_IT(dra_uart, &rx_byte, 1);
+}
+
+static int push(dra_cmd_t cmd, const dra_group_t *g, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+static int push(dra_cmd_t cmd, const dra_group_t *g, const char *fmt, ...)
+{
+    if (q_count >= DRA_QUEUE) return -1;
+
+    dra_entry_t *e = &queue[(q_head + q_count) % DRA_QUEUE];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(e->text, sizeof(e->text) - 2, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= sizeof(e->text) - 2) return -1;
+
+    e->text[n++] = '\r';
+    e->text[n++] = '\n';
+    e->len = (uint16_t)n;
+    e->cmd = cmd;
+    if (g) e->group = *g;
+    q_count++;
+    return 0;
+}
+
+int dra_connect(void)
+{
+    return push(DRA_CMD_CONNECT, NULL, "AT+DMOCONNECT");
+}
+
+int dra_setGroup(const dra_group_t *g)
+{
+    if (g->tx_freq < DRA_FREQ_MIN || g->tx_freq > DRA_FREQ_MAX ||
+        g->rx_freq < DRA_FREQ_MIN || g->rx_freq > DRA_FREQ_MAX ||
+        g->squelch > 8 || g->tx_ctcss > 38 || g->rx_ctcss > 38) {
+        return -1;
+    }
+    return push(DRA_CMD_GROUP, g, "AT+DMOSETGROUP=%u,%lu.%04lu,%lu.%04lu,%04u,%u,%04u",
+                g->wide ? 1U : 0U,
+                (unsigned long)(g->tx_freq / 10000), (unsigned long)(g->tx_freq % 10000),
+                (unsigned long)(g->rx_freq / 10000), (unsigned long)(g->rx_freq % 10000),
+                g->tx_ctcss, g->squelch, g->rx_ctcss);
+}
+
+int dra_setVolume(uint8_t vol)
+{
+    if (vol < 1 || vol > 8) return -1;
+    return push(DRA_CMD_VOLUME, NULL, "AT+DMOSETVOLUME=%u", vol);
+}
+
+int dra_setFilter(uint8_t emphasis, uint8_t highpass, uint8_t lowpass)
+{
+    return push(DRA_CMD_FILTER, NULL, "AT+SETFILTER=%u,%u,%u",
+                emphasis ? 1U : 0U, highpass ? 1U : 0U, lowpass ? 1U : 0U);
+}
+
+uint8_t dra_busy(void)
+{
+    return q_count != 0;
+}
+
+const dra_result_t *dra_result(void)
+{
+    return &result;
+}
+
+const dra_group_t *dra_group(void)
+{
+    return &group;
+}
+
+int dra_parseFreq(const char *s, uint32_t *freq)
+{
+    uint32_t mhz = 0, frac = 0;
+    uint8_t digits = 0;
+
+    if (*s < '0' || *s > '9') return -1;
+    while (*s >= '0' && *s <= '9') mhz = mhz * 10 + (uint32_t)(*s++ - '0');
+    if (*s == '.') {
+        s++;
+        while (*s >= '0' && *s <= '9' && digits < 4) {
+            frac = frac * 10 + (uint32_t)(*s++ - '0');
+            digits++;
+        }
+    }
+    if (*s != '\0' && *s != ',') return -1;
+    while (digits++ < 4) frac *= 10;
+
+    uint32_t f = mhz * 10000 + frac;
+    if (f < DRA_FREQ_MIN || f > DRA_FREQ_MAX) return -1;
+    *freq = f;
+    return 0;
+}
+
+static void send(uint32_t now)
+{
+    dra_entry_t *e = &queue[q_head];
+
+    memcpy(tx_buf, e->text, e->len);
+    if (HAL_UART_Transmit_IT(dra_uart, (uint8_t *)tx_buf, e->len) != HAL_OK) return;
+    if (tries == 0) first_tick = now;
+    tries++;
+    sent_tick = now;
+    in_flight = 1;
+}
+
+static dra_event_t finish(uint8_t ok, uint32_t now)
+{
+    dra_entry_t *e = &queue[q_head];
+
+    result.name = cmds[e->cmd].name;
+    result.tries = tries;
+    result.ms = now - first_tick;
+    if (ok && e->cmd == DRA_CMD_GROUP) group = e->group;
+
+    q_head = (uint8_t)((q_head + 1) % DRA_QUEUE);
+    q_count--;
+    in_flight = 0;
+    tries = 0;
+    return ok ? DRA_EV_OK : DRA_EV_FAILED;
+}
+
+/* One reply line: 1 ok, 0 error, -1 not the reply to the command in flight */
+static int parse(const char *l)
+{
+    const char *prefix = cmds[queue[q_head].cmd].reply;
+    size_t n = strlen(prefix);
+
+    if (strncmp(l, prefix, n) != 0) return -1;
+    return l[n] == '0';
+}
+
+dra_event_t dra_Poll(uint32_t now)
+{
+    while (rx_tail != rx_head) {
+        char c = (char)rx_ring[rx_tail];
+        rx_tail = (uint8_t)((rx_tail + 1) % DRA_RX_RING);
+
+        if (c == '\r') continue;
+        if (c != '\n') {
+            if (line_len < DRA_LINE_MAX - 1) line[line_len++] = c;
+            continue;
+        }
+        line[line_len] = '\0';
+        line_len = 0;
+        if (!in_flight) continue;
+
+        int r = parse(line);
+        if (r == 1) return finish(1, now);
+        if (r == 0) {
+            /* Negative reply: try again straight away */
+            if (tries >= DRA_TRIES) return finish(0, now);
+            in_flight = 0;
+        }
+    }
+
+    if (q_count == 0) return DRA_EV_NONE;
+    if (in_flight) {
+        if (now - sent_tick < DRA_REPLY_MS) return DRA_EV_NONE;
+        if (tries >= DRA_TRIES) return finish(0, now);
+        in_flight = 0;
+    }
+    if (dra_uart->gState == HAL_UART_STATE_READY) send(now);
+    return DRA_EV_NONE;
+}
+
+void dra_rxDone(UART_HandleTypeDef *huart)
+{
+    if (huart != dra_uart) return;
+
+    uint8_t next = (uint8_t)((rx_head + 1) % DRA_RX_RING);
+    if (next != rx_tail) {
+        rx_ring[rx_head] = rx_byte;
+        rx_head = next;
+    }
+    HAL_UART_Receive_IT(dra_uart, &rx_byte, 1);
+}
+
+void dra_rxError(UART_HandleTypeDef *huart)
+{
+    if (huart != dra_uart) return;
+    HAL_UART_Receive_IT(dra_uart, &rx_byte, 1);
+}
@@ -0,0 +1,42 @@
+/* frag.c
+ * Splits records longer than one APRS frame into numbered fragments
+ */
+
+#include "frag.h"
+#include <stdio.h>
+#include <string.h>
+
+int frag_Begin(frag_t *f, const char *data, uint16_t len, uint16_t max_payload, uint8_t id)
+{
+    if (max_payload <= FRAG_HEADER_MAX) return -1;
+
+    f->data = data;
+    f->len = len;
+    f->pos = 0;
+    f->chunk = (uint16_t)(max_payload - FRAG_HEADER_MAX);
+    f->id = id;
+    f->index = 0;
+
+    uint16_t count = (uint16_t)((len + f->chunk - 1) / f->chunk);
+    if (count == 0) count = 1;
+    if (count > FRAG_MAX_COUNT) return -1;
+    f->count = (uint8_t)count;
+    return f->count;
+}
+
+int frag_next(frag_t *f, char *out, size_t size)
+{
+    if (f->index >= f->count) return 0;
+
+    uint16_t n = f->len - f->pos;
+    if (n > f->chunk) n = f->chunk;
+
+    int h = snprintf(out, size, ">#F%02X,%u/%u:", f->id, f->index + 1, f->count);
+    if (h < 0 || (size_t)h + n + 1 > size) return 0;
+
+    memcpy(out + h, f->data + f->pos, n);
+    out[h + n] = 0;
+    f->pos += n;
+    f->index++;
+    return h + n;
+}
@@ -0,0 +1,138 @@
+/* fx25.c
+ * FX.25 forward error correction wrapper for AX.25 frames.
+ *
+ * The AX.25 frame is HDLC-framed (flags + bit stuffing) into a byte
+ * block, padded with flag bits and protected by Reed-Solomon check bytes.
+ * A 64-bit correlation tag in front identifies the code. Plain AX.25
+ * receivers ignore the tag and check bytes and still decode the frame.
+ */
+
+#include "fx25.h"
+#include "ax25.h"
+#include "rs.h"
+#include <string.h>
+
+/* Correlation tags (FX.25 spec, Tag_01 .. Tag_0B) */
+typedef struct {
+    uint64_t tag;
+    uint8_t  n;          /* block size on air */
+    uint8_t  k;          /* data bytes */
+} fx25_mode_t;
+
+static const fx25_mode_t modes[] = {
+    { 0xB74DB7DF8A532F3EULL, 255, 239 },  /* Tag_01 */
+    { 0x26FF60A600CC8FDEULL, 144, 128 },  /* Tag_02 */
+    { 0xC7DC0508F3D9B09EULL,  80,  64 },  /* Tag_03 */
+    { 0x8F056EB4369660EEULL,  48,  32 },  /* Tag_04 */
+    { 0x6E260B1AC5835FAEULL, 255, 223 },  /* Tag_05 */
+    { 0xFF94DC634F1CFF4EULL, 160, 128 },  /* Tag_06 */
+    { 0x1EB7B9CDBC09C00EULL,  96,  64 },  /* Tag_07 */
+    { 0xDBF869BD2DBB1776ULL,  64,  32 },  /* Tag_08 */
+    { 0x3ADB0C13DEAE2836ULL, 255, 191 },  /* Tag_09 */
+    { 0xAB69DB6A543188D6ULL, 192, 128 },  /* Tag_0A */
+    { 0x4A4ABEC4A724B796ULL, 128,  64 },  /* Tag_0B */
+};
+#define NUM_MODES (sizeof(modes) / sizeof(modes[0]))
+
+/* FX.25 codes: first consecutive root alpha^1 */
+#define FX25_FCR  1
+
+static rs_code_t rs16, rs32, rs64;
+
+/* Bit packer for the HDLC-framed block (LSB-first) */
+typedef struct {
+    uint8_t *buf;
+    uint16_t max_bits;
+    uint16_t bits;
+    uint8_t  ones;
+} bitpack_t;
+
+static int put_bit(bitpack_t *p, uint8_t bit)
+{
+    if (p->bits >= p->max_bits) return -1;
+    if (bit) p->buf[p->bits >> 3] |= (uint8_t)(1U << (p->bits & 7));
+    p->bits++;
+    return 0;
+}
+
+static int put_flag(bitpack_t *p)
+{
+    for (uint8_t i = 0; i < 8; i++) {
+        if (put_bit(p, (AX25_FLAG >> i) & 1)) return -1;
+    }
+    return 0;
+}
+
+static int put_stuffed(bitpack_t *p, uint8_t byte)
+{
+    for (uint8_t i = 0; i < 8; i++) {
+        uint8_t bit = (byte >> i) & 1;
+        if (put_bit(p, bit)) return -1;
+        if (bit) {
+            if (++p->ones == 5) {
+                if (put_bit(p, 0)) return -1;
+                p->ones = 0;
+            }
+        } else {
+            p->ones = 0;
+        }
+    }
+    return 0;
+}
+
+void fx25_Init(void)
+{
+    rs_Init();
+    rs_InitCode(&rs16, 16, FX25_FCR);
+    rs_InitCode(&rs32, 32, FX25_FCR);
+    rs_InitCode(&rs64, 64, FX25_FCR);
+}
+
+uint16_t fx25_encode(const uint8_t *frame, uint16_t frame_len,
+                     uint8_t check_bytes, uint8_t *out)
+{
+    const rs_code_t *rs;
+
+    switch (check_bytes) {
+    case 16: rs = &rs16; break;
+    case 32: rs = &rs32; break;
+    case 64: rs = &rs64; break;
+    default: return 0;
+    }
+    if (!frame || !out || frame_len == 0) return 0;
+
+    /* HDLC-frame into the data area, sized for the largest block */
+    uint8_t *data = out + FX25_TAG_LEN;
+    bitpack_t p = { data, (uint16_t)((FX25_MAX_BLOCK - check_bytes) * 8U), 0, 0 };
+    memset(data, 0, FX25_MAX_BLOCK - check_bytes);
+
+    if (put_flag(&p)) return 0;
+    for (uint16_t i = 0; i < frame_len; i++) {
+        if (put_stuffed(&p, frame[i])) return 0;
+    }
+    if (put_flag(&p)) return 0;
+
+    uint16_t used = (uint16_t)((p.bits + 7U) / 8U);
+
+    /* Smallest block of this code family that holds the frame */
+    const fx25_mode_t *m = NULL;
+    for (uint8_t i = 0; i < NUM_MODES; i++) {
+        if (modes[i].n - modes[i].k != check_bytes || modes[i].k < used) continue;
+        if (!m || modes[i].k < m->k) m = &modes[i];
+    }
+    if (!m) return 0;
+
+    /* Pad with continuous flag pattern up to k bytes */
+    p.max_bits = (uint16_t)(m->k * 8U);
+    for (uint8_t i = 0; p.bits < p.max_bits; i = (uint8_t)((i + 1) & 7)) {
+        put_bit(&p, (AX25_FLAG >> i) & 1);
+    }
+
+    for (uint8_t i = 0; i < FX25_TAG_LEN; i++) {
+        out[i] = (uint8_t)(m->tag >> (8 * i));  /* LSB first on air */
+    }
+
+    rs_encode(rs, data, m->k, data + m->k);
+
+    return (uint16_t)(FX25_TAG_LEN + m->n);
+}
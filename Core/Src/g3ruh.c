@@ -0,0 +1,28 @@
+/* g3ruh.c
+ * G3RUH 9600 bps FSK shaped-pulse table.
+ *
+ * Raised-cosine pulse (alpha = 0.5) truncated to 4 bit periods, sampled
+ * 4x per bit. Each entry is the sum of the pulses of the last 4 scrambled
+ * bits (+1 / -1), scaled to the 0..15 range of the 4-bit DAC.
+ */
+
+#include "g3ruh.h"
+
+const uint8_t g3ruh_pulse[16][G3RUH_SAMPLES_PER_BIT] = {
+    { 2,  2,  2,  2},  /* 0000 */
+    { 2,  1,  1,  1},  /* 0001 */
+    { 4,  7, 10, 13},  /* 0010 */
+    { 3,  6,  9, 12},  /* 0011 */
+    {13, 10,  7,  4},  /* 0100 */
+    {12,  9,  6,  3},  /* 0101 */
+    {14, 15, 15, 14},  /* 0110 */
+    {14, 14, 14, 13},  /* 0111 */
+    { 1,  1,  1,  2},  /* 1000 */
+    { 1,  0,  0,  1},  /* 1001 */
+    { 3,  6,  9, 12},  /* 1010 */
+    { 2,  5,  8, 11},  /* 1011 */
+    {12,  9,  6,  3},  /* 1100 */
+    {11,  8,  5,  2},  /* 1101 */
+    {13, 14, 14, 14},  /* 1110 */
+    {13, 13, 13, 13},  /* 1111 */
+};
@@ -0,0 +1,211 @@
+/* idle.c
+ * Low-power idle: WFI and Stop mode
+ *
+ * The RTC runs from the LSI with PREDIV_A = 1, so the wakeup timer
+ * (RTCCLK / 2) and the sub-second counter tick at the same rate. The
+ * sub-second counter measures how long a Stop really lasted; the core
+ * clock, SysTick and DWT are all stopped meanwhile. Registers are used
+ * directly, the HAL RTC driver is not part of this build.
+ */
+
+#include "idle.h"
+#include "main.h"
+#include "dwt.h"
+
+#define IDLE_PREDIV_A       1U
+#define IDLE_PREDIV_S       32767U
+#define IDLE_SSR_MASK       0x7FFFU
+/* Calibration window against the core clock, RTC ticks (~50 ms) */
+#define IDLE_CAL_TICKS      800U
+/* Wake latency assumed until a timer wake has measured a longer one */
+#define IDLE_LATENCY_US     200U
+/* Shortest Stop worth entering, RTC ticks (~1 ms) */
+#define IDLE_MIN_TICKS      16U
+
+/* RS485 line (USART1 half duplex, PA9) and the RTC wakeup timer */
+#define IDLE_EXTI_RS485     EXTI_IMR_MR9
+#define IDLE_EXTI_RTC       EXTI_IMR_MR22
+
+static idle_stats_t st;
+static uint32_t tick_frac;      /* RTC ticks not yet added to the HAL tick */
+static uint32_t lead_us = IDLE_LATENCY_US;   /* worst wake latency since boot */
+
+static void rtc_unlock(void)
+{
+    RTC->WPR = 0xCA;
+    RTC->WPR = 0x53;
+}
+
+static void rtc_lock(void)
+{
+    RTC->WPR = 0xFF;
+}
+
+/* Sub-second down-counter; read twice as the shadow registers are bypassed */
+static uint32_t rtc_ssr(void)
+{
+    uint32_t a, b = RTC->SSR;
+    do {
+        a = b;
+        b = RTC->SSR;
+    } while (a != b);
+    return a & IDLE_SSR_MASK;
+}
+
+static uint32_t ssr_elapsed(uint32_t from, uint32_t to)
+{
+    return (from - to) & IDLE_SSR_MASK;
+}
+
+/* Measure the LSI against the core clock (HSI, 1 %) */
+static void idle_Calibrate(void)
+{
+    uint32_t s0 = rtc_ssr();
+    uint32_t s;
+
+    while ((s = rtc_ssr()) == s0) {
+    }
+    uint32_t c0 = dwt_cycles();
+    while (ssr_elapsed(s, rtc_ssr()) < IDLE_CAL_TICKS) {
+    }
+    uint32_t c1 = dwt_cycles();
+
+    st.rtc_hz = (uint32_t)((uint64_t)IDLE_CAL_TICKS * HAL_RCC_GetHCLKFreq() / (c1 - c0));
+}
+
+void idle_Init(void)
+{
+    dwt_Init();
+
+    __HAL_RCC_PWR_CLK_ENABLE();
+    PWR->CR |= PWR_CR_DBP;
+    RCC->CSR |= RCC_CSR_LSION;
+    while (!(RCC->CSR & RCC_CSR_LSIRDY)) {
+    }
+
+    /* The RTC clock source can only be changed by a backup domain reset */
+    if ((RCC->BDCR & RCC_BDCR_RTCSEL) != RCC_BDCR_RTCSEL_1) {
+        RCC->BDCR |= RCC_BDCR_BDRST;
+        RCC->BDCR &= ~RCC_BDCR_BDRST;
+        RCC->BDCR |= RCC_BDCR_RTCSEL_1;
+    }
+    RCC->BDCR |= RCC_BDCR_RTCEN;
+
+    rtc_unlock();
+    RTC->ISR |= RTC_ISR_INIT;
+    while (!(RTC->ISR & RTC_ISR_INITF)) {
+    }
+    RTC->PRER = IDLE_PREDIV_S;
+    RTC->PRER = IDLE_PREDIV_S | (IDLE_PREDIV_A << RTC_PRER_PREDIV_A_Pos);
+    RTC->ISR &= ~RTC_ISR_INIT;
+    RTC->CR |= RTC_CR_BYPSHAD;
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    rtc_lock();
+
+    /* Wake events only, no interrupts: Stop is entered with WFE */
+    __HAL_RCC_SYSCFG_CLK_ENABLE();
+    SYSCFG->EXTICR[2] &= ~SYSCFG_EXTICR3_EXTI9;         /* port A */
+    EXTI->FTSR |= IDLE_EXTI_RS485;                      /* start bit */
+    EXTI->RTSR |= IDLE_EXTI_RTC;
+    EXTI->IMR &= ~(IDLE_EXTI_RS485 | IDLE_EXTI_RTC);
+    EXTI->EMR |= IDLE_EXTI_RTC;
+
+    idle_Calibrate();
+    idle_resetStats();
+}
+
+void idle_sleep(void)
+{
+    uint32_t c0 = dwt_cycles();
+
+    __WFI();
+    st.sleep_us += (dwt_cycles() - c0) / (SystemCoreClock / 1000000U);
+    st.sleeps++;
+}
+
+static void wakeup_Arm(uint32_t ticks)
+{
+    rtc_unlock();
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    while (!(RTC->ISR & RTC_ISR_WUTWF)) {
+    }
+    RTC->WUTR = ticks - 1U;
+    RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | RTC_CR_WUCKSEL_1 | RTC_CR_WUCKSEL_0;  /* RTCCLK / 2 */
+    RTC->ISR &= ~RTC_ISR_WUTF;
+    RTC->CR |= RTC_CR_WUTE | RTC_CR_WUTIE;
+    rtc_lock();
+}
+
+static void wakeup_Disarm(void)
+{
+    rtc_unlock();
+    RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+    RTC->ISR &= ~RTC_ISR_WUTF;
+    rtc_lock();
+}
+
+idle_wake_t idle_stop(uint32_t ms)
+{
+    if (ms > IDLE_STOP_MAX_MS) ms = IDLE_STOP_MAX_MS;
+
+    uint32_t ticks = (uint32_t)((uint64_t)ms * st.rtc_hz / 1000U);
+    uint32_t lead = (uint32_t)((uint64_t)lead_us * st.rtc_hz / 1000000U) + ticks / 128U + 1U;
+    if (ticks < lead + IDLE_MIN_TICKS) return IDLE_WAKE_SKIPPED;
+    ticks -= lead;
+
+    wakeup_Arm(ticks);
+    EXTI->PR = IDLE_EXTI_RS485 | IDLE_EXTI_RTC;
+    EXTI->EMR |= IDLE_EXTI_RS485;
+    uint32_t s0 = rtc_ssr();
+
+    HAL_SuspendTick();
+    HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFE);
+
+    /* Back on HSI with the AHB/APB prescalers kept */
+    uint32_t c0 = dwt_cycles();
+    uint32_t elapsed = ssr_elapsed(s0, rtc_ssr());
+    idle_wake_t why = (RTC->ISR & RTC_ISR_WUTF) ? IDLE_WAKE_TIMER
+                    : (EXTI->PR & IDLE_EXTI_RS485) ? IDLE_WAKE_RS485 : IDLE_WAKE_OTHER;
+
+    EXTI->EMR &= ~IDLE_EXTI_RS485;
+    wakeup_Disarm();
+    EXTI->PR = IDLE_EXTI_RS485 | IDLE_EXTI_RTC;
+
+    tick_frac += elapsed * 1000U;
+    uwTick += tick_frac / st.rtc_hz;
+    st.stop_ms += tick_frac / st.rtc_hz;
+    tick_frac %= st.rtc_hz;
+    HAL_ResumeTick();
+
+    st.stops++;
+    if (why == IDLE_WAKE_RS485) st.rs485_wakes++;
+    if (why == IDLE_WAKE_TIMER) {
+        /* Past the expiry by the regulator, HSI and flash wake-up time plus
+         * the restore above; resolution one RTC tick (~60 us)
+         */
+        uint32_t late = (elapsed > ticks) ? elapsed - ticks : 0;
+        uint32_t us = (uint32_t)((uint64_t)late * 1000000U / st.rtc_hz)
+                    + (dwt_cycles() - c0) / (SystemCoreClock / 1000000U);
+        if (us < st.lat_min_us) st.lat_min_us = us;
+        if (us > st.lat_max_us) st.lat_max_us = us;
+        if (us > lead_us) lead_us = us;
+        st.lat_sum_us += us;
+        st.lat_n++;
+    }
+    return why;
+}
+
+const idle_stats_t *idle_stats(void)
+{
+    return &st;
+}
+
+void idle_resetStats(void)
+{
+    uint32_t hz = st.rtc_hz;
+
+    st = (idle_stats_t){0};
+    st.rtc_hz = hz;
+    st.window_tick = HAL_GetTick();
+    st.lat_min_us = UINT32_MAX;
+}
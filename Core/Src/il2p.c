@@ -0,0 +1,171 @@
+/* il2p.c
+ * IL2P (Improved Layer 2 Protocol) encoder, max-FEC mode.
+ *
+ * Replaces HDLC flags and bit stuffing with a sync word, a compact
+ * translated header and Reed-Solomon protected, scrambled blocks.
+ */
+
+#include "il2p.h"
+#include "ax25.h"
+#include "rs.h"
+#include <string.h>
+
+/* IL2P codes: first consecutive root alpha^0 */
+#define IL2P_FCR  0
+
+static const uint8_t sync_word[IL2P_SYNC_LEN] = { 0xF1, 0x5E, 0x48 };
+
+static rs_code_t rs_hdr, rs_blk;
+
+/* ---- scrambler: x^9 + x^4 + 1, MSB-first, 5-bit pipeline delay ---- */
+
+#define IL2P_LFSR_INIT  0x00F
+
+static uint8_t scramble_bit(uint8_t in, uint16_t *state)
+{
+    uint8_t out = (uint8_t)(((*state >> 4) ^ *state) & 1U);
+    *state = (uint16_t)(((((in ^ *state) & 1U) << 9) | (*state ^ ((*state & 1U) << 4))) >> 1);
+    return out;
+}
+
+static void scramble_block(const uint8_t *in, uint8_t *out, uint16_t len)
+{
+    uint16_t lfsr = IL2P_LFSR_INIT;
+    uint16_t ob = 0;
+    uint8_t om = 0x80;
+    uint8_t skipping = 1;
+
+    memset(out, 0, len);
+
+    for (uint16_t ib = 0; ib < len; ib++) {
+        for (uint8_t im = 0x80; im != 0; im >>= 1) {
+            uint8_t s = scramble_bit((in[ib] & im) != 0, &lfsr);
+            if (ib == 0 && im == 0x04) skipping = 0;
+            if (!skipping) {
+                if (s) out[ob] |= om;
+                om >>= 1;
+                if (om == 0) { om = 0x80; ob++; }
+            }
+        }
+    }
+
+    /* Flush the 5 bits still in the pipeline */
+    for (uint8_t n = 0; n < 5; n++) {
+        if (scramble_bit(0, &lfsr)) out[ob] |= om;
+        om >>= 1;
+        if (om == 0) { om = 0x80; ob++; }
+    }
+}
+
+/* ---- header ---- */
+
+/* Spread value over one bit column of the header, LSB at lsb_index */
+static void set_field(uint8_t *hdr, uint8_t bit, int8_t lsb_index, uint8_t width, uint16_t value)
+{
+    while (width-- > 0 && lsb_index >= 0) {
+        if (value & 1U) hdr[lsb_index] |= (uint8_t)(1U << bit);
+        value >>= 1;
+        lsb_index--;
+    }
+}
+
+static int sixbit_call(uint8_t *dst, const char *call)
+{
+    size_t n = strlen(call);
+    if (n > 6) return -1;
+
+    for (uint8_t i = 0; i < 6; i++) {
+        char c = (i < n) ? call[i] : ' ';
+        if (c < 0x20 || c > 0x5F) return -1;
+        dst[i] = (uint8_t)(c - 0x20);
+    }
+    return 0;
+}
+
+/* AX.25 PID -> 4-bit IL2P PID, -1 if not representable */
+static int encode_pid(uint8_t pid)
+{
+    switch (pid) {
+    case 0x01: return 0x3;
+    case 0x06: return 0x4;
+    case 0x07: return 0x5;
+    case 0x08: return 0x6;
+    case 0xCC: return 0xB;
+    case 0xCD: return 0xC;
+    case 0xCE: return 0xD;
+    case 0xCF: return 0xE;
+    case 0xF0: return 0xF;
+    default:   break;
+    }
+    if ((pid & 0x30) == 0x10 || (pid & 0x30) == 0x20) return 0x2;
+    return -1;
+}
+
+void il2p_Init(void)
+{
+    rs_Init();
+    rs_InitCode(&rs_hdr, IL2P_HEADER_PARITY, IL2P_FCR);
+    rs_InitCode(&rs_blk, IL2P_BLOCK_PARITY, IL2P_FCR);
+}
+
+uint16_t il2p_encode(const uint8_t *frame, uint16_t frame_len,
+                     uint8_t *out, uint16_t out_size)
+{
+    ax25_frame_t f;
+    uint8_t hdr[IL2P_HEADER_LEN];
+    const uint8_t *payload;
+    uint16_t payload_len;
+
+    if (!out || ax25_decode(frame, frame_len, &f) != 0) return 0;
+
+    memset(hdr, 0, sizeof(hdr));
+    int pid = encode_pid(f.pid);
+
+    if (f.path_count == 0 && f.control == AX25_CTRL_UI && pid >= 0 &&
+        sixbit_call(&hdr[0], f.dst) == 0 && sixbit_call(&hdr[6], f.src) == 0) {
+        /* Type 1: translated header, payload is the info field */
+        hdr[12] = (uint8_t)((f.dst_ssid << 4) | f.src_ssid);
+        set_field(hdr, 6, 0, 1, 1);                  /* UI */
+        set_field(hdr, 6, 4, 4, (uint16_t)pid);      /* PID */
+        set_field(hdr, 6, 11, 7, 0);                 /* control: UI, P/F clear */
+        set_field(hdr, 7, 1, 1, 1);                  /* header type 1 */
+        payload = f.info;
+        payload_len = f.info_len;
+    } else {
+        /* Type 0: transparent, payload is the whole frame minus FCS */
+        memset(hdr, 0, sizeof(hdr));
+        payload = frame;
+        payload_len = frame_len - AX25_FCS_LEN;
+    }
+
+    if (payload_len > IL2P_MAX_PAYLOAD) return 0;
+    set_field(hdr, 7, 0, 1, 1);                      /* max FEC */
+    set_field(hdr, 7, 11, 10, payload_len);          /* payload byte count */
+
+    if (IL2P_MAX_OUT(payload_len) > out_size) return 0;
+
+    uint16_t idx = 0;
+    memcpy(&out[idx], sync_word, IL2P_SYNC_LEN);
+    idx += IL2P_SYNC_LEN;
+
+    scramble_block(hdr, &out[idx], IL2P_HEADER_LEN);
+    rs_encode(&rs_hdr, &out[idx], IL2P_HEADER_LEN, &out[idx + IL2P_HEADER_LEN]);
+    idx += IL2P_HEADER_LEN + IL2P_HEADER_PARITY;
+
+    if (payload_len == 0) return idx;
+
+    /* Split into nearly equal blocks of at most 239 bytes */
+    uint16_t blocks = (uint16_t)((payload_len + IL2P_MAX_BLOCK_DATA - 1) / IL2P_MAX_BLOCK_DATA);
+    uint16_t small = payload_len / blocks;
+    uint16_t large_count = payload_len - blocks * small;
+
+    for (uint16_t b = 0; b < blocks; b++) {
+        uint16_t n = (b < large_count) ? (uint16_t)(small + 1) : small;
+        scramble_block(payload, &out[idx], n);
+        rs_encode(&rs_blk, &out[idx], n, &out[idx + n]);
+        idx += n + IL2P_BLOCK_PARITY;
+        payload += n;
+    }
+
+    return idx;
+}
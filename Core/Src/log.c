@@ -0,0 +1,205 @@
+/* log.c
+ * Non-blocking debug log: binary records in a ring, drained by USART DMA
+ *
+ * log_write() only packs the id, tick and raw arguments (a few hundred
+ * cycles); formatting happens on the ground or, with LOG_TEXT_OUTPUT,
+ * in log_Poll(). The ring has one producer (main loop) and one consumer
+ * (DMA), so head and tail need no lock: each is written by one side only.
+ */
+
+#include "log.h"
+#include <stdarg.h>
+#include <string.h>
+
+#define LOG_MASK  (LOG_RING_SIZE - 1U)
+
+static UART_HandleTypeDef *log_uart;
+static uint8_t ring[LOG_RING_SIZE];
+static volatile uint32_t head;          /* written by log_write */
+static volatile uint32_t tail;          /* advanced when bytes are sent */
+static volatile uint16_t in_flight;     /* DMA transfer length, 0 = idle */
+static uint32_t dropped, dropped_total;
+
+#if LOG_TEXT_OUTPUT
+static char text[LOG_STR_MAX + 96];
+#endif
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/* Copy one record into the ring, 0 if it fits */
+static int push(const uint8_t *rec, uint16_t len)
+{
+    uint32_t h = head;
+    if (LOG_RING_SIZE - (h - tail) < len) return -1;
+
+    uint16_t first = (uint16_t)(LOG_RING_SIZE - (h & LOG_MASK));
+    if (first > len) first = len;
+    memcpy(&ring[h & LOG_MASK], rec, first);
+    memcpy(ring, rec + first, len - first);
+
+    __DMB();
+    head = h + len;
+    return 0;
+}
+
+static uint16_t make_header(uint8_t *rec, log_id_t id, uint8_t args_len)
+{
+    rec[0] = LOG_SYNC;
+    rec[1] = (uint8_t)id;
+    rec[2] = args_len;
+    put_u32(&rec[3], HAL_GetTick());
+    return (uint16_t)(LOG_HDR_LEN + args_len);
+}
+
+/* Start DMA on the next contiguous run of the ring */
+static void kick(void)
+{
+#if !LOG_TEXT_OUTPUT
+    if (!log_uart || in_flight) return;
+
+    uint32_t t = tail;
+    uint32_t n = head - t;
+    if (n == 0) return;
+    if (n > LOG_RING_SIZE - (t & LOG_MASK)) n = LOG_RING_SIZE - (t & LOG_MASK);
+
+    in_flight = (uint16_t)n;
+    if (HAL_UART_Transmit_DMA(log_uart, &ring[t & LOG_MASK], (uint16_t)n) != HAL_OK) {
+        in_flight = 0;
+    }
+#endif
+}
+
+static void commit(uint8_t *rec, uint16_t len)
+{
+    uint8_t d[LOG_HDR_LEN + 4];
+
+    if (dropped) {
+        put_u32(&d[LOG_HDR_LEN], dropped);
+        if (push(d, make_header(d, LOG_DROPPED, 4)) == 0) dropped = 0;
+    }
+    if (dropped || push(rec, len) != 0) {
+        dropped++;
+        dropped_total++;
+        return;
+    }
+    kick();
+}
+
+void log_Init(UART_HandleTypeDef *huart)
+{
+    log_uart = huart;
+    head = tail = 0;
+    in_flight = 0;
+    dropped = dropped_total = 0;
+}
+
+void log_write(log_id_t id, ...)
+{
+    uint8_t rec[LOG_HDR_LEN + LOG_ARGS_MAX];
+    uint16_t n = LOG_HDR_LEN;
+    va_list ap;
+
+    if ((unsigned)id >= LOG_COUNT) return;
+
+    /* One argument per conversion, sized by the length modifier */
+    va_start(ap, id);
+    for (const char *f = log_formats[id]; *f; f++) {
+        if (*f != '%') continue;
+        if (*++f == '%') continue;
+        while (*f && strchr("-+ #0123456789.", *f)) f++;
+        char mod = 0;
+        while (*f && strchr("hlz", *f)) mod = *f++;
+        if (!*f) break;
+
+        if (*f == 's') {
+            const char *s = va_arg(ap, const char *);
+            size_t sl = s ? strlen(s) : 0;
+            if (sl > LOG_STR_MAX) sl = LOG_STR_MAX;
+            if (n + 1 + sl > sizeof(rec)) break;
+            rec[n++] = (uint8_t)sl;
+            memcpy(&rec[n], s, sl);
+            n += (uint16_t)sl;
+        } else {
+            uint32_t v = (mod == 'l') ? (uint32_t)va_arg(ap, unsigned long) :
+                         (mod == 'z') ? (uint32_t)va_arg(ap, size_t) :
+                         (uint32_t)va_arg(ap, unsigned int);
+            if ((size_t)n + 4 > sizeof(rec)) break;
+            put_u32(&rec[n], v);
+            n += 4;
+        }
+    }
+    va_end(ap);
+
+    make_header(rec, id, (uint8_t)(n - LOG_HDR_LEN));
+    commit(rec, n);
+}
+
+void log_text(const char *s)
+{
+    uint8_t rec[LOG_HDR_LEN + 1 + LOG_STR_MAX];
+    size_t sl = strlen(s);
+
+    while (sl > 0 && (s[sl - 1] == '\r' || s[sl - 1] == '\n')) sl--;
+    if (sl > LOG_STR_MAX) sl = LOG_STR_MAX;
+
+    rec[LOG_HDR_LEN] = (uint8_t)sl;
+    memcpy(&rec[LOG_HDR_LEN + 1], s, sl);
+    commit(rec, make_header(rec, LOG_TEXT, (uint8_t)(1 + sl)));
+}
+
+void log_Poll(void)
+{
+#if LOG_TEXT_OUTPUT
+    uint8_t rec[LOG_HDR_LEN + LOG_ARGS_MAX];
+
+    if (!log_uart || in_flight) return;
+
+    /* Pop one record: header first, then its arguments */
+    uint32_t t = tail;
+    uint32_t avail = head - t;
+    if (avail < LOG_HDR_LEN) return;
+    for (uint16_t i = 0; i < LOG_HDR_LEN; i++) rec[i] = ring[(t + i) & LOG_MASK];
+    uint16_t len = (uint16_t)(LOG_HDR_LEN + rec[2]);
+    for (uint16_t i = LOG_HDR_LEN; i < len; i++) rec[i] = ring[(t + i) & LOG_MASK];
+    tail = t + len;
+
+    int n = log_fmt_expand(text, sizeof(text) - 2, rec[1], &rec[LOG_HDR_LEN], rec[2]);
+    if (n < 0) return;
+    text[n++] = '\r';
+    text[n++] = '\n';
+
+    in_flight = (uint16_t)n;
+    if (HAL_UART_Transmit_DMA(log_uart, (uint8_t *)text, (uint16_t)n) != HAL_OK) {
+        in_flight = 0;
+    }
+#else
+    kick();
+#endif
+}
+
+void log_txDone(UART_HandleTypeDef *huart)
+{
+    if (huart != log_uart) return;
+
+#if !LOG_TEXT_OUTPUT
+    tail += in_flight;
+#endif
+    in_flight = 0;
+    kick();
+}
+
+uint8_t log_idle(void)
+{
+    return head == tail && in_flight == 0 && dropped == 0;
+}
+
+uint32_t log_dropped(void)
+{
+    return dropped_total;
+}
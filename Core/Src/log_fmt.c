@@ -0,0 +1,68 @@
+/* log_fmt.c
+ * Debug log message table and record expansion (firmware and host)
+ */
+
+#include "log_fmt.h"
+#include <stdio.h>
+#include <string.h>
+
+const char *const log_formats[LOG_COUNT] = {
+#define LOG_FMT_TEXT(id, fmt) fmt,
+    LOG_FORMATS(LOG_FMT_TEXT)
+#undef LOG_FMT_TEXT
+};
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int log_fmt_expand(char *out, size_t size, uint8_t id, const uint8_t *args, uint8_t len)
+{
+    if (id >= LOG_COUNT || size == 0) return -1;
+
+    const char *f = log_formats[id];
+    const uint8_t *end = args + len;
+    size_t n = 0;
+    out[0] = 0;
+
+    while (*f && n + 1 < size) {
+        if (*f != '%' || f[1] == '%') {
+            out[n++] = *f;
+            f += (*f == '%') ? 2 : 1;
+            continue;
+        }
+
+        /* Conversion spec without length modifiers: all arguments are 32 bit */
+        char spec[16];
+        size_t k = 0;
+        spec[k++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && k < sizeof(spec) - 2) spec[k++] = *f++;
+        while (*f && strchr("hlz", *f)) f++;
+        char conv = *f ? *f++ : 's';
+        spec[k++] = conv;
+        spec[k] = 0;
+
+        int w;
+        if (conv == 's') {
+            char str[LOG_STR_MAX + 1];
+            if (args >= end || args + 1 + args[0] > end) return -1;
+            uint8_t sl = args[0] > LOG_STR_MAX ? LOG_STR_MAX : args[0];
+            memcpy(str, args + 1, sl);
+            str[sl] = 0;
+            args += 1 + args[0];
+            w = snprintf(out + n, size - n, spec, str);
+        } else {
+            if (args + 4 > end) return -1;
+            uint32_t v = get_u32(args);
+            args += 4;
+            if (conv == 'd' || conv == 'i') w = snprintf(out + n, size - n, spec, (int)(int32_t)v);
+            else if (conv == 'c') w = snprintf(out + n, size - n, spec, (int)v);
+            else w = snprintf(out + n, size - n, spec, (unsigned)v);
+        }
+        if (w < 0) return -1;
+        n += ((size_t)w < size - n) ? (size_t)w : size - n - 1;
+    }
+    out[n] = 0;
+    return (int)n;
+}
@@ -6,14 +6,32 @@
 #include "main.h"
 #include "afsk.h"
 #include "ax25.h"
+#include "fx25.h"
+#include "il2p.h"
+#include "bench.h"
+#include "obc_link.h"
+#include "tlm.h"
+#include "batch.h"
+#include "frag.h"
+#include "sched.h"
+#include "txgov.h"
+#include "log.h"
+#include "trace.h"
+#include "tickstat.h"
+#include "stats.h"
+#include "clock.h"
+#include "idle.h"
+#include "dra818.h"
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 
 /* Hardware handles */
 UART_HandleTypeDef huart1; /* RS-485 half duplex (USART1) */
 UART_HandleTypeDef huart2; /* Debug (USART2) */
+DMA_HandleTypeDef  hdma_usart2_tx; /* debug log (DMA1 Stream6 Ch4) */
 UART_HandleTypeDef huart6; /* DRA818U (USART6) */
 TIM_HandleTypeDef  htim3;  /* sample timer */
 
@@ -27,16 +45,184 @@ static const uint8_t PATH1_SSID = 1;
 static const char PATH2_CALL[] = "WIDE2";
 static const uint8_t PATH2_SSID = 1;
 
+/* Modem profile at boot; the OBC can switch per pass with "$MODEM,<baud>"
+ * (300, 1200, 2400 or 9600)
+ */
+#define MODEM_DEFAULT AFSK_PROFILE_AFSK1200
+
+/* FX.25 check bytes at boot (0 = plain AX.25); "$FX25,<0|16|32|64>" */
+#define FX25_DEFAULT_CHECK 16
+
+/* IL2P framing instead of AX.25/FX.25 at boot; "$IL2P,<0|1>" */
+#define IL2P_DEFAULT 0
+
+/* DRA818U channel at boot: 435.2480 MHz simplex, 12.5 kHz, no CTCSS,
+ * squelch 0. Set in the background by the AT driver; "$DRA,FREQ,<tx MHz>
+ * [,<rx MHz>]" | "$DRA,SQ,<0-8>" | "$DRA,VOL,<1-8>" | "$DRA,FILTER,<e>,<h>,<l>"
+ */
+#define DRA_FREQ             4352480UL      /* 100 Hz units */
+#define DRA_VOLUME           8
+
+/* Status frame layout: ">" line ["^" line ...] STATUS_SUFFIX */
+#define STATUS_SUFFIX " | Somaiya OrbitRadio-5 73"
+
+/* Text lines are packed into one status frame until the oldest has waited
+ * this long (ms) or the frame is full; "$BATCH,<ms>", 0 = one frame per line
+ */
+#define BATCH_WINDOW_MS 3000
+
+/* Radio key-up sequence (ms) */
+#define RADIO_PRE_TX_MS      200
+#define RADIO_TXD_MS         500
+#define RADIO_TAIL_MS        100
+#define RADIO_TX_TIMEOUT_MS  15000
+/* A frame waits this long past key-up start for the burst clock, then is
+ * encoded on the clock it has
+ */
+#define RADIO_CLOCK_WAIT_MS  1000
+
+/* TX budget: average duty cycle and PA energy over rolling windows.
+ * Frames over budget wait in the scheduler. "$TXGOV" prints the state.
+ */
+#define TX_DUTY_PERMILLE     250        /* 25 % keyed on average */
+#define TX_DUTY_WINDOW_MS    600000     /* up to 150 s keyed in a burst */
+#define TX_POWER_MW          3750       /* DRA818U at 1 W: ~750 mA at 5 V */
+#define TX_ENERGY_AVG_MW     500        /* orbit-average power for the PA */
+#define TX_ENERGY_WINDOW_MS  5400000    /* one orbit */
+
+/* Identification beacon, queued in the beacon class */
+#define BEACON_INTERVAL_MS   600000
+#define BEACON_TEXT          ">BeliefSat OrbitRadio-5 APRS telemetry 435.248 MHz"
+
+/* Lines from the OBC starting with this are alarms: sent on their own, ahead
+ * of everything else
+ */
+#define ALARM_PREFIX         '!'
+
+/* RS485 receive ring, filled from the USART1 interrupt */
+#define RS485_RX_RING        512
+#define RS485_TX_MAX         256
+
+/* Health counters as an APRS status frame every STATS_INTERVAL_MS;
+ * "$STATS,<s>", 0 = only on request
+ */
+#define STATS_INTERVAL_MS    0
+
+/* Core clock while a frame is encoded, and otherwise (on air, queue
+ * empty); "$CLOCK,<burst MHz>,<idle MHz>" (8, 16 or 180)
+ */
+#define CLOCK_BURST          CLOCK_PROFILE_PLL180
+#define CLOCK_IDLE           CLOCK_PROFILE_LP8
+/* A switch retunes USART1: it waits until no RS485 byte has arrived for
+ * this long, so it does not land inside a character
+ */
+#define CLOCK_RX_QUIET_MS    2
+
+/* The main loop sleeps (WFI) whenever it has nothing to do. After this
+ * long without RS485 input or transmissions, with nothing queued, it
+ * enters Stop until the next periodic frame is due; "$IDLE,<ms>",
+ * 0 = WFI only. The byte that wakes the modem from Stop is lost, and
+ * bytes for RS485_WAKE_GUARD_MS after it are dropped, so Stop is only
+ * for an OBC that sends a wake byte first (README, OBC Interface).
+ */
+#define IDLE_STOP_AFTER_MS   0
+#define IDLE_STOP_MIN_MS     10
+#define RS485_WAKE_GUARD_MS  2
+
 /* buffers */
 #define AX25_BUF_SIZE 4096
 static uint8_t ax25_buffer[AX25_BUF_SIZE];
 static uint16_t ax25_len = 0;
+static uint8_t fx25_buffer[FX25_MAX_OUT];
+static uint8_t fx25_check_bytes = FX25_DEFAULT_CHECK;
+static uint8_t il2p_buffer[IL2P_MAX_OUT(300)];
+static uint8_t il2p_enabled = IL2P_DEFAULT;
 static char rs485_msg[LINE_BUF_SIZE];
 static uint16_t rs485_len = 0;
+static obc_link_t obc_link;
+static uint16_t tlm_seq = 0;
+static batch_t status_batch;
+static uint32_t batch_window_ms = BATCH_WINDOW_MS;
+static uint8_t frag_id = 0;
+
+static volatile uint8_t rs485_ring[RS485_RX_RING];
+static volatile uint16_t rs485_head = 0;
+static uint16_t rs485_tail = 0;
+static uint8_t rs485_rx_byte;
+static char rs485_tx[RS485_TX_MAX];
+
+typedef enum {
+    RADIO_IDLE = 0,
+    RADIO_PRE_TX,
+    RADIO_TXD,
+    RADIO_ON_AIR,
+    RADIO_TAIL
+} radio_state_t;
+
+/* Fixed frames rendered once into line bits, replayed by the modulator.
+ * Room for an FX.25 block or a stuffed AX.25 frame with a short payload.
+ */
+#define TX_CACHE_SLOTS       (1 + APRS_TLM_DEF_COUNT)
+#define TX_CACHE_PAYLOAD     128
+
+typedef struct {
+    char          payload[TX_CACHE_PAYLOAD];
+    afsk_stream_t stream;
+    uint8_t       bits[AFSK_STREAM_BYTES(FX25_MAX_OUT)];
+} tx_cache_t;
+
+static tx_cache_t tx_cache[TX_CACHE_SLOTS];
+static uint8_t tx_cache_count = 0;
+static uint8_t tx_cache_dirty = 1;
+
+static radio_state_t radio_state = RADIO_IDLE;
+static uint32_t radio_tick;
+static uint32_t radio_key_tick;
+static uint32_t beacon_tick;
+static uint32_t stats_tick;
+static uint32_t stats_interval_ms = STATS_INTERVAL_MS;
+static clock_profile_id_t clock_burst = CLOCK_BURST;
+static clock_profile_id_t clock_idle = CLOCK_IDLE;
+static uint32_t idle_stop_after_ms = IDLE_STOP_AFTER_MS;
+static uint32_t idle_active_tick;
+static volatile uint8_t rs485_wake_guard;
+static volatile uint32_t rs485_wake_tick;
+static volatile uint32_t rs485_rx_tick;
+static uint8_t dra_booting, dra_boot_failed;
+
+/* DAC pin masks - precomputed for fast atomic writes (DAC_Write4, main.h) */
+uint32_t dac_bsrr[16];
+
+/* TIM3 update: direct-register handler from SRAM, or through HAL
+ * ("$FASTISR,<0|1>", to compare the two with $TICKSTAT)
+ */
+#define TIM3_FAST_ISR  1
+volatile uint8_t tim3_fast_isr = TIM3_FAST_ISR;
 
-/* DAC pin masks - precomputed for fast atomic writes */
-static uint32_t dac_set_masks[16];
-static uint32_t dac_reset_masks[16];
+/* TIM3 period dithering: the period alternates between base and base + 1
+ * timer clocks so the average is exactly tim_clk / rate, spread evenly
+ * (Bresenham on the remainder). With dithering off ("$RATE,0") the period
+ * is rounded, e.g. 1667 for 9600 Hz from 16 MHz, 200 ppm slow.
+ */
+#define TIM3_DITHER    1
+
+typedef struct {
+    uint32_t tim_clk;
+    uint32_t rate;          /* target sample rate */
+    uint32_t base;          /* tim_clk / rate, timer clocks */
+    uint32_t rem;           /* tim_clk % rate, 0 = fixed period */
+    uint32_t acc;
+} tim3_frac_t;
+
+static tim3_frac_t tim3_frac;
+static uint8_t tim3_dither = TIM3_DITHER;
+/* TIM3 counts only from PRE_TX to the end of the frame (TIM3_Run) */
+static uint8_t tim3_running;
+
+/* Carried by the tick trace events so trace_parse can tell a gap from a
+ * long period
+ */
+static uint8_t tick_seq;
 
 /* forward declarations */
 void SystemClock_Config(void);
@@ -45,39 +231,48 @@ void USART2_Init(void);
 void USART1_Init(void);
 void USART6_Init(void);
 void TIM3_Init(void);
+void TIM3_SetSampleRate(uint32_t rate);
+static void TIM3_Run(uint8_t on);
 void DAC_PrecomputeMasks(void);
 
-static void Debug_Print(const char *s);
 static void RS485_SetReceive(void);
-static void DRA_Send(const char *s);
+static void RS485_SetTransmit(void);
+static int RS485_Send(const char *line);
 static void DRA_Init(void);
+static void DRA_Poll(void);
+static void DRA_HandleCommand(const char *args);
+static void Modem_Select(afsk_profile_id_t id);
+static int Clock_Select(clock_profile_id_t id);
+static void UART_Retune(UART_HandleTypeDef *huart);
+static void RS485_HandleCommand(const char *cmd);
+static void Radio_Queue(sched_class_t cls, const char *payload);
+static void Radio_Prepare(const char *payload);
+static int Radio_Frame(const char *payload, afsk_stream_t *s);
+static void TxCache_Build(void);
+static const afsk_stream_t *TxCache_Find(const char *payload);
+static void Radio_Poll(void);
+static uint32_t Radio_EstimateKeyMs(uint16_t payload_len);
+static void Beacon_Poll(void);
+static void RS485_HandleByte(uint8_t b);
+static void RS485_HandleLink(obc_rx_t rx);
+static void RS485_HandleText(uint8_t b);
+static uint8_t RS485_ReadByte(uint8_t *b);
+static void Telemetry_Send(const uint8_t *rec, uint16_t len);
+static void Status_Queue(const char *line);
+static void Status_Flush(void);
+static void Status_SendFragmented(const char *line);
+static void Tick_Report(void);
+static void Stats_Report(void);
+static void Stats_Poll(void);
+static void Idle_Poll(void);
+static void Idle_Report(void);
+static void Rate_Report(void);
 void Debug_PrintClocks(void);
 
 /* External function to check if AFSK is still transmitting */
 extern uint8_t afsk_isBusy(void);
 extern uint32_t afsk_getBitsRemaining(void);
 
-/* Optimized DAC write function using precomputed BSRR masks
- * This sets all 4 bits atomically in a single register write
- *
- * NOTE: This assumes all DAC pins are on GPIOA. If they're on different
- * ports, use the slower individual write version.
- */
-void DAC_Write4(uint8_t v)
-{
-#if 1
-    /* FAST VERSION: Atomic write using BSRR (requires all pins on same port) */
-    /* BSRR lower 16 bits = set, upper 16 bits = reset */
-    GPIOA->BSRR = dac_set_masks[v & 0x0F] | dac_reset_masks[v & 0x0F];
-#else
-    /* SLOW VERSION: Individual GPIO writes (use if pins on different ports) */
-    HAL_GPIO_WritePin(LSB_GPIO_Port, LSB_Pin,   (v>>0) & 1 ? GPIO_PIN_SET : GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(BIT_1_GPIO_Port, BIT_1_Pin, (v>>1) & 1 ? GPIO_PIN_SET : GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(BIT_2_GPIO_Port, BIT_2_Pin, (v>>2) & 1 ? GPIO_PIN_SET : GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(MSB_GPIO_Port, MSB_Pin,   (v>>3) & 1 ? GPIO_PIN_SET : GPIO_PIN_RESET);
-#endif
-}
-
 /* Precompute BSRR masks for all 16 possible DAC values */
 void DAC_PrecomputeMasks(void)
 {
@@ -94,16 +289,48 @@ void DAC_PrecomputeMasks(void)
         /* MSB (bit 3) */
         if (v & 0x08) set_mask |= MSB_Pin; else reset_mask |= (MSB_Pin << 16);
 
-        dac_set_masks[v] = set_mask;
-        dac_reset_masks[v] = reset_mask;
+        dac_bsrr[v] = set_mask | reset_mask;
     }
 }
 
-/* HAL timer callback - calls afsk tick */
+/* ARR is preloaded: the value written here sets the period after the one
+ * that just started. A few cycles, in SRAM with the rest of the path.
+ */
+__STATIC_FORCEINLINE void TIM3_Dither(void)
+{
+    if (tim3_frac.rem == 0) return;
+    tim3_frac.acc += tim3_frac.rem;
+    if (tim3_frac.acc >= tim3_frac.rate) {
+        tim3_frac.acc -= tim3_frac.rate;
+        TIM3->ARR = tim3_frac.base;             /* base + 1 clocks */
+    } else {
+        TIM3->ARR = tim3_frac.base - 1U;
+    }
+}
+
+/* TIM3 update, direct: only the update interrupt is enabled, so there is
+ * nothing to dispatch. Runs from SRAM with the whole sample path (no
+ * flash wait states once the core clock needs them).
+ */
+RAMFUNC void TIM3_SampleIRQ(void)
+{
+    tickstat_enter();
+    TIM3->SR = ~TIM_SR_UIF;
+    TIM3_Dither();
+    trace_event(TRACE_TICK_IN, tick_seq);
+    afsk_timer_tick();
+    trace_event(TRACE_TICK_OUT, tick_seq++);
+    tickstat_exit();
+}
+
+/* HAL timer callback - calls afsk tick (tim3_fast_isr == 0) */
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
     if (htim->Instance == TIM3) {
+        TIM3_Dither();
+        trace_event(TRACE_TICK_IN, tick_seq);
         afsk_timer_tick();
+        trace_event(TRACE_TICK_OUT, tick_seq++);
     }
 }
 
@@ -114,16 +341,34 @@ int main(void)
 
     GPIO_Init();
     DAC_PrecomputeMasks();  /* Precompute DAC masks for fast writes */
+    trace_Init(HAL_RCC_GetHCLKFreq());
 
     USART2_Init(); /* debug */
+    log_Init(&huart2);
     USART6_Init(); /* DRA */
     USART1_Init(); /* RS485 half duplex */
-    TIM3_Init();   /* sample timer */
 
-    /* init afsk */
+    /* init afsk (before TIM3, which takes its rate from the modem profile) */
     afsk_Init();
+    afsk_setProfile(MODEM_DEFAULT);
+    fx25_Init();
+    il2p_Init();
+    obc_link_Init(&obc_link);
+    tlm_Init();
+    batch_Init(&status_batch, ">", STATUS_SUFFIX);
+    sched_Init();
+    {
+        const txgov_cfg_t gov = {
+            TX_DUTY_PERMILLE, TX_DUTY_WINDOW_MS,
+            TX_POWER_MW, TX_ENERGY_AVG_MW, TX_ENERGY_WINDOW_MS
+        };
+        txgov_Init(&gov, HAL_GetTick());
+    }
 
-    Debug_Print("\r\n=== BeliefSat OrbitRadio-5 APRS MODEM v2 ===\r\n");
+    TIM3_Init();   /* sample timer */
+    idle_Init();   /* RTC wakeup timer, LSI calibration */
+
+    log_write(LOG_BANNER);
 
     /* Print clock info for debugging */
     Debug_PrintClocks();
@@ -131,130 +376,54 @@ int main(void)
     DRA_Init();
     RS485_SetReceive();
 
-    Debug_Print("RS485 listening...\r\n");
+    HAL_UART_Receive_IT(&huart1, &rs485_rx_byte, 1);
+    log_write(LOG_RS485_LISTEN);
+
+    /* main loop: RS485 bytes are buffered by the USART1 interrupt and
+     * handled here; frames go through the scheduler to the radio state
+     * machine, so nothing waits for a transmission to finish
+     */
+    Radio_Queue(SCHED_BEACON, BEACON_TEXT);
+    beacon_tick = HAL_GetTick();
+    stats_tick = beacon_tick;
+    idle_active_tick = beacon_tick;
 
-    /* main loop: read RS485 line-by-line, form APRS message, encode, generate, transmit */
     for (;;)
     {
         uint8_t b;
-        if (HAL_UART_Receive(&huart1, &b, 1, HAL_MAX_DELAY) == HAL_OK)
-        {
-            HAL_GPIO_TogglePin(LD2_GPIO_Port, LD2_Pin);
-
-            if (b == '\r') continue;
-            if (b == '\n' || rs485_len >= (LINE_BUF_SIZE - 2))
-            {
-                rs485_msg[rs485_len] = '\0';
-                Debug_Print("RS485: ");
-                Debug_Print(rs485_msg);
-                Debug_Print("\r\n");
-
-                /* Build APRS payload with Data Type Identifier
-                 * '>' = Status message (most appropriate for telemetry)
-                 * Format: >status text
-                 */
-                char payload[256];
-                snprintf(payload, sizeof(payload), ">%s | Somaiya OrbitRadio-5 73", rs485_msg);
-
-                /* prepare AX.25 frame */
-                ax25_len = 0;
-                ax25_encode(ax25_buffer, &ax25_len,
-                            SRC_CALL, SRC_SSID,
-                            DST_CALL, DST_SSID,
-                            PATH1_CALL, PATH1_SSID,
-                            PATH2_CALL, PATH2_SSID,
-                            payload);
-
-                char dbg[80];
-                snprintf(dbg, sizeof(dbg), "AX.25 frame: %u bytes (payload: %zu chars)\r\n",
-                         ax25_len, strlen(payload));
-                Debug_Print(dbg);
-
-                /* Pre-TX delay - system stabilization */
-                HAL_Delay(200);
-
-                /* Enable PTT */
-                HAL_GPIO_WritePin(PTT_UHF_GPIO_Port, PTT_UHF_Pin, GPIO_PIN_SET);
-                Debug_Print("PTT ON\r\n");
-
-                /* TX Delay (TXD) - wait for radio to key up
-                 * DRA818U typically needs 300-500ms
-                 */
-                HAL_Delay(500);
-
-                /* Generate AFSK bit stream from AX.25 frame */
-                afsk_generate(ax25_buffer, ax25_len);
-
-                /* Debug: show bit count */
-                snprintf(dbg, sizeof(dbg), "AFSK bits queued: %lu\r\n", afsk_getBitsRemaining());
-                Debug_Print(dbg);
-
-                /* Start transmission */
-                afsk_start();
-                Debug_Print("TX started...\r\n");
-
-                /* Wait for transmission to complete */
-                uint32_t start_time = HAL_GetTick();
-                uint32_t timeout = start_time + 15000;  /* 15 second max */
-
-                while (afsk_isBusy()) {
-                    if (HAL_GetTick() > timeout) {
-                        Debug_Print("TX timeout!\r\n");
-                        break;
-                    }
-                }
-
-                uint32_t tx_time = HAL_GetTick() - start_time;
-                snprintf(dbg, sizeof(dbg), "TX complete: %lu ms\r\n", tx_time);
-                Debug_Print(dbg);
-
-                /* Post-TX delay before releasing PTT */
-                HAL_Delay(100);
-
-                /* Stop AFSK and release PTT */
-                afsk_stop();
-                HAL_GPIO_WritePin(PTT_UHF_GPIO_Port, PTT_UHF_Pin, GPIO_PIN_RESET);
-                Debug_Print("PTT OFF\r\n\r\n");
-
-                /* Clear receive buffer */
-                rs485_len = 0;
-                memset(rs485_msg, 0, sizeof(rs485_msg));
-            }
-            else
-            {
-                rs485_msg[rs485_len++] = (char)b;
-            }
+        while (RS485_ReadByte(&b)) {
+            RS485_HandleByte(b);
         }
+        /* A frame left open by a stray zero must not hold the text path */
+        if (HAL_GetTick() - rs485_rx_tick >= OBC_LINK_IDLE_MS) {
+            RS485_HandleLink(obc_link_idle(&obc_link));
+        }
+
+        if (batch_due(&status_batch, HAL_GetTick(), batch_window_ms)) {
+            Status_Flush();
+        }
+        Beacon_Poll();
+        Stats_Poll();
+        DRA_Poll();
+        Radio_Poll();
+        log_Poll();
+        trace_Poll();
+        Idle_Poll();
     }
 }
 
-/* System Clock config: use HSI 16 MHz, no PLL */
+/* System Clock config: HSI 16 MHz, no PLL; switched at run time by
+ * Clock_Select
+ */
 void SystemClock_Config(void)
 {
-    RCC_OscInitTypeDef osc = {0};
-    RCC_ClkInitTypeDef clk = {0};
-
-    __HAL_RCC_PWR_CLK_ENABLE();
-    __HAL_PWR_VOLTAGESCALING_CONFIG(PWR_REGULATOR_VOLTAGE_SCALE2);
-
-    osc.OscillatorType = RCC_OSCILLATORTYPE_HSI;
-    osc.HSIState = RCC_HSI_ON;
-    osc.HSICalibrationValue = RCC_HSICALIBRATION_DEFAULT;
-    osc.PLL.PLLState = RCC_PLL_NONE;
-    HAL_RCC_OscConfig(&osc);
-
-    clk.ClockType = RCC_CLOCKTYPE_SYSCLK|RCC_CLOCKTYPE_HCLK|RCC_CLOCKTYPE_PCLK1|RCC_CLOCKTYPE_PCLK2;
-    clk.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
-    clk.AHBCLKDivider = RCC_SYSCLK_DIV1;
-    clk.APB1CLKDivider = RCC_HCLK_DIV1;
-    clk.APB2CLKDivider = RCC_HCLK_DIV1;
-
-    HAL_RCC_ClockConfig(&clk, FLASH_LATENCY_0);
+    if (clock_setProfile(CLOCK_PROFILE_HSI16) != 0) {
+        Error_Handler();
+    }
 }
 
 void Debug_PrintClocks(void)
 {
-    char buf[100];
     uint32_t sysclk = HAL_RCC_GetSysClockFreq();
     uint32_t hclk = HAL_RCC_GetHCLKFreq();
     uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
@@ -264,17 +433,13 @@ void Debug_PrintClocks(void)
         tim_clk = pclk1 * 2;
     }
 
-    snprintf(buf, sizeof(buf), "SYSCLK: %lu Hz\r\n", sysclk);
-    Debug_Print(buf);
-    snprintf(buf, sizeof(buf), "HCLK: %lu Hz\r\n", hclk);
-    Debug_Print(buf);
-    snprintf(buf, sizeof(buf), "PCLK1: %lu Hz, TIM3 clk: %lu Hz\r\n", pclk1, tim_clk);
-    Debug_Print(buf);
+    log_write(LOG_SYSCLK, sysclk);
+    log_write(LOG_HCLK, hclk);
+    log_write(LOG_PCLK1, pclk1, tim_clk);
 
     uint32_t period = TIM3->ARR + 1;
     uint32_t actual_rate = tim_clk / period;
-    snprintf(buf, sizeof(buf), "TIM3 ARR: %lu, Sample rate: %lu Hz\r\n", TIM3->ARR, actual_rate);
-    Debug_Print(buf);
+    log_write(LOG_TIM3, TIM3->ARR, actual_rate);
 }
 
 /* GPIO init - WITH PA15 JTAG RELEASE */
@@ -362,6 +527,27 @@ void USART2_Init(void)
     huart2.Init.Mode = UART_MODE_TX_RX;
     huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
     HAL_UART_Init(&huart2);
+
+    /* Debug log TX by DMA (USART2_TX = DMA1 Stream6 Channel 4) */
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    hdma_usart2_tx.Instance = DMA1_Stream6;
+    hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+    hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+    hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_usart2_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&hdma_usart2_tx);
+    __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+
+    /* Last of the UARTs; TIM3 preempts it, so it never delays a sample */
+    HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 1, 2);
+    HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+    HAL_NVIC_SetPriority(USART2_IRQn, 1, 2);
+    HAL_NVIC_EnableIRQ(USART2_IRQn);
 }
 
 /* USART1 half-duplex (PA9) */
@@ -385,6 +571,10 @@ void USART1_Init(void)
     huart1.Init.Mode = UART_MODE_TX_RX;
     huart1.Init.HwFlowCtl = UART_HWCONTROL_NONE;
     HAL_HalfDuplex_Init(&huart1);
+
+    /* Receive by interrupt into the RS485 ring; preempted by TIM3 */
+    HAL_NVIC_SetPriority(USART1_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(USART1_IRQn);
 }
 
 /* USART6 for DRA818U (PC6 TX, PC7 RX) */
@@ -408,24 +598,62 @@ void USART6_Init(void)
     huart6.Init.Mode = UART_MODE_TX_RX;
     huart6.Init.HwFlowCtl = UART_HWCONTROL_NONE;
     HAL_UART_Init(&huart6);
+
+    /* AT replies by interrupt; below RS485, preempted by TIM3 */
+    HAL_NVIC_SetPriority(USART6_IRQn, 1, 1);
+    HAL_NVIC_EnableIRQ(USART6_IRQn);
+}
+
+/* TIM3 kernel clock: PCLK1, doubled when APB1 is divided */
+static uint32_t TIM3_ClockHz(void)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+        return pclk1 * 2;
+    }
+    return pclk1;
 }
 
-/* TIM3 init: 9600 Hz sample rate for AFSK1200 */
+/* Plan the TIM3 periods for a sample rate: base + rem/rate clocks when
+ * dithering, else rounded. Returns the first period.
+ */
+static uint32_t TIM3_PeriodFor(uint32_t rate)
+{
+    uint32_t tim_clk = TIM3_ClockHz();
+
+    tim3_frac.tim_clk = tim_clk;
+    tim3_frac.rate = rate;
+    tim3_frac.acc = 0;
+    if (tim3_dither) {
+        tim3_frac.base = tim_clk / rate;
+        tim3_frac.rem = tim_clk % rate;
+    } else {
+        tim3_frac.base = (tim_clk + rate / 2) / rate;
+        tim3_frac.rem = 0;
+    }
+    if (tim3_frac.base < 1) tim3_frac.base = 1;
+    return tim3_frac.base;
+}
+
+/* Mean TIM3 period in CPU cycles, the nominal tick interval */
+static uint32_t TIM3_NominalCycles(void)
+{
+    uint64_t clocks_x_rate = (uint64_t)tim3_frac.base * tim3_frac.rate + tim3_frac.rem;
+
+    return (uint32_t)((clocks_x_rate * HAL_RCC_GetHCLKFreq() / tim3_frac.tim_clk
+                       + tim3_frac.rate / 2) / tim3_frac.rate);
+}
+
+/* TIM3 init: sample rate of the active modem profile
+ * (9600 Hz for AFSK300/1200, 19200 Hz for AFSK2400, 38400 Hz for G3RUH9600)
+ */
 void TIM3_Init(void)
 {
     __HAL_RCC_TIM3_CLK_ENABLE();
 
     htim3.Instance = TIM3;
 
-    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
-    uint32_t tim_clk = pclk1;
-    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
-        tim_clk = pclk1 * 2;
-    }
-
-    /* Calculate period for 9600 Hz with rounding */
-    uint32_t period = (tim_clk + 4800) / 9600;
-    if (period < 1) period = 1;
+    uint32_t period = TIM3_PeriodFor(afsk_getSampleRate());
 
     htim3.Init.Prescaler = 0;
     htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
@@ -436,11 +664,815 @@ void TIM3_Init(void)
 
     __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
 
+    tickstat_Reset(TIM3_NominalCycles());
     HAL_TIM_Base_Start_IT(&htim3);
-    HAL_NVIC_SetPriority(TIM3_IRQn, 0, 0);  /* Highest priority */
+    tim3_running = 1;
+    HAL_NVIC_SetPriority(TIM3_IRQn, 0, 0);  /* Highest priority, preempts the UARTs */
     HAL_NVIC_EnableIRQ(TIM3_IRQn);
 }
 
+/* Reprogram the sample timer (between frames only). The timer and its
+ * interrupt are stopped first: TIM3_Dither() reads tim3_frac on every
+ * sample, so it must not see the plan half rewritten.
+ */
+void TIM3_SetSampleRate(uint32_t rate)
+{
+    HAL_NVIC_DisableIRQ(TIM3_IRQn);
+    __HAL_TIM_DISABLE(&htim3);
+
+    uint32_t period = TIM3_PeriodFor(rate);
+    __HAL_TIM_SET_AUTORELOAD(&htim3, period - 1);
+    __HAL_TIM_SET_COUNTER(&htim3, 0);
+    htim3.Init.Period = period - 1;
+    /* ARR is preloaded: load it now, not after one period at the old rate */
+    TIM3->EGR = TIM_EGR_UG;
+    __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+    HAL_NVIC_ClearPendingIRQ(TIM3_IRQn);
+    tickstat_Reset(TIM3_NominalCycles());
+
+    HAL_NVIC_EnableIRQ(TIM3_IRQn);
+    if (tim3_running) __HAL_TIM_ENABLE(&htim3);
+}
+
+/* Start or stop the sample timer. Between frames it has nothing to do,
+ * and at 9600-38400 interrupts a second it would end every WFI of the
+ * idle loop; afsk_stop() has already left the DAC at mid-level.
+ */
+static void TIM3_Run(uint8_t on)
+{
+    if (on == tim3_running) return;
+    tim3_running = on;
+
+    if (on) {
+        __HAL_TIM_SET_COUNTER(&htim3, 0);
+        tickstat_restart();
+        __HAL_TIM_ENABLE(&htim3);
+    } else {
+        __HAL_TIM_DISABLE(&htim3);
+        __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+        HAL_NVIC_ClearPendingIRQ(TIM3_IRQn);
+    }
+}
+
+/* Switch modem profile and retune TIM3 to its sample rate */
+static void Modem_Select(afsk_profile_id_t id)
+{
+    if (afsk_isBusy()) return;
+
+    afsk_setProfile(id);
+    TIM3_SetSampleRate(afsk_getSampleRate());
+
+    const afsk_profile_t *p = afsk_getProfile();
+    log_write(LOG_MODEM, p->name, p->sample_rate, p->samples_per_bit);
+}
+
+/* USART baud rate from the current bus clock (USART1/6 on APB2) */
+static void UART_Retune(UART_HandleTypeDef *huart)
+{
+    uint32_t pclk = (huart->Instance == USART1 || huart->Instance == USART6)
+                    ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+
+    __HAL_UART_DISABLE(huart);
+    huart->Instance->BRR = UART_BRR_SAMPLING16(pclk, huart->Init.BaudRate);
+    __HAL_UART_ENABLE(huart);
+}
+
+/* Switch the core clock and re-derive everything that runs from it.
+ * Only while no frame is on air (one may be loaded), with no UART
+ * transmission in flight and USART1 not in the middle of receiving;
+ * returns -1 to try again later. SysTick is re-derived by
+ * HAL_RCC_ClockConfig.
+ */
+static int Clock_Select(clock_profile_id_t id)
+{
+    if (id == clock_getProfile()) return 0;
+    if (afsk_isRunning() || dra_busy()) return -1;
+    if (huart1.gState != HAL_UART_STATE_READY || huart2.gState != HAL_UART_STATE_READY ||
+        !__HAL_UART_GET_FLAG(&huart2, UART_FLAG_TC)) {
+        return -1;
+    }
+    if (__HAL_UART_GET_FLAG(&huart1, UART_FLAG_RXNE) ||
+        HAL_GetTick() - rs485_rx_tick < CLOCK_RX_QUIET_MS) {
+        return -1;
+    }
+
+    int rc = clock_setProfile(id);
+
+    UART_Retune(&huart1);
+    UART_Retune(&huart2);
+    UART_Retune(&huart6);
+    TIM3_SetSampleRate(afsk_getSampleRate());
+    trace_Init(HAL_RCC_GetHCLKFreq());
+
+    log_write(LOG_CLOCK, clock_profileInfo(clock_getProfile())->name, HAL_RCC_GetHCLKFreq());
+    return rc;
+}
+
+/* RS485 command lines:
+ *   "$MODEM,<baud>" | "$FX25,<check bytes>" | "$IL2P,<0|1>" | "$BATCH,<ms>"
+ *   | "$PREAMBLE,<flags>" | "$TXGOV" | "$TICKSTAT" | "$FASTISR,<0|1>"
+ *   | "$STATS[,<s>]" | "$CLOCK[,<burst MHz>,<idle MHz>]"
+ *   | "$IDLE[,<ms>]" | "$RATE[,<0|1>]" | "$DRA[,...]"
+ *   | "$TRACE[,<0|1>]" | "$BENCH"
+ */
+static void RS485_HandleCommand(const char *cmd)
+{
+    if (strncmp(cmd, "$MODEM,", 7) == 0) {
+        int id = afsk_findProfile((uint16_t)strtoul(cmd + 7, NULL, 10));
+        if (id >= 0) {
+            Modem_Select((afsk_profile_id_t)id);
+            return;
+        }
+    } else if (strncmp(cmd, "$FX25,", 6) == 0) {
+        unsigned long n = strtoul(cmd + 6, NULL, 10);
+        if (n == 0 || n == 16 || n == 32 || n == 64) {
+            fx25_check_bytes = (uint8_t)n;
+            tx_cache_dirty = 1;
+            log_write(LOG_FX25, n ? "on" : "off");
+            return;
+        }
+    } else if (strncmp(cmd, "$IL2P,", 6) == 0) {
+        il2p_enabled = (cmd[6] == '1');
+        tx_cache_dirty = 1;
+        log_write(LOG_IL2P, il2p_enabled ? "on" : "off");
+        return;
+    } else if (strncmp(cmd, "$BATCH,", 7) == 0) {
+        batch_window_ms = strtoul(cmd + 7, NULL, 10);
+        if (batch_window_ms == 0) Status_Flush();
+        log_write(LOG_BATCH_SET);
+        return;
+    } else if (strncmp(cmd, "$PREAMBLE,", 10) == 0) {
+        unsigned long n = strtoul(cmd + 10, NULL, 10);
+        if (n >= 1 && n <= 1000) {
+            afsk_setPreambleFlags((uint16_t)n);
+            log_write(LOG_PREAMBLE_SET);
+            return;
+        }
+    } else if (strcmp(cmd, "$TXGOV") == 0) {
+        const txgov_state_t *g = txgov_state();
+        log_write(LOG_TXGOV, (long)(g->duty_us / 1000), (long)(g->energy_uj / 1000),
+                  g->keyed_ms, g->deferrals);
+        return;
+    } else if (strcmp(cmd, "$TICKSTAT") == 0) {
+        Tick_Report();
+        return;
+    } else if (strncmp(cmd, "$FASTISR,", 9) == 0) {
+        tim3_fast_isr = (cmd[9] == '1');
+        tickstat_Reset(TIM3_NominalCycles());
+        log_write(LOG_FASTISR, tim3_fast_isr ? "direct" : "HAL");
+        return;
+    } else if (strcmp(cmd, "$TRACE") == 0) {
+        log_write(LOG_TRACE, trace_getTicks() ? "on" : "off", trace_lost);
+        return;
+    } else if (strncmp(cmd, "$TRACE,", 7) == 0) {
+        trace_setTicks(cmd[7] == '1');
+        log_write(LOG_TRACE, trace_getTicks() ? "on" : "off", trace_lost);
+        return;
+    } else if (strcmp(cmd, "$STATS") == 0) {
+        Stats_Report();
+        return;
+    } else if (strncmp(cmd, "$STATS,", 7) == 0) {
+        stats_interval_ms = strtoul(cmd + 7, NULL, 10) * 1000UL;
+        stats_tick = HAL_GetTick();
+        log_write(LOG_STATS_SET);
+        return;
+    } else if (strcmp(cmd, "$CLOCK") == 0) {
+        log_write(LOG_CLOCK, clock_profileInfo(clock_getProfile())->name, HAL_RCC_GetHCLKFreq());
+        return;
+    } else if (strncmp(cmd, "$CLOCK,", 7) == 0) {
+        char *end;
+        int burst = clock_findProfile(strtoul(cmd + 7, &end, 10));
+        int idle = (*end == ',') ? clock_findProfile(strtoul(end + 1, NULL, 10)) : -1;
+        if (burst >= 0 && idle >= 0) {
+            clock_burst = (clock_profile_id_t)burst;
+            clock_idle = (clock_profile_id_t)idle;
+            log_write(LOG_CLOCK_SET, clock_profileInfo(clock_burst)->name,
+                      clock_profileInfo(clock_idle)->name);
+            return;
+        }
+    } else if (strcmp(cmd, "$IDLE") == 0) {
+        Idle_Report();
+        return;
+    } else if (strncmp(cmd, "$IDLE,", 6) == 0) {
+        idle_stop_after_ms = strtoul(cmd + 6, NULL, 10);
+        log_write(LOG_IDLE_SET, idle_stop_after_ms);
+        return;
+    } else if (strcmp(cmd, "$RATE") == 0) {
+        Rate_Report();
+        return;
+    } else if (strncmp(cmd, "$RATE,", 6) == 0) {
+        /* Retunes TIM3 - only between frames */
+        if (!afsk_isBusy()) {
+            tim3_dither = (cmd[6] == '1');
+            TIM3_SetSampleRate(afsk_getSampleRate());
+            log_write(LOG_RATE_SET, tim3_dither ? "on" : "off");
+            return;
+        }
+    } else if (strcmp(cmd, "$DRA") == 0) {
+        const dra_group_t *g = dra_group();
+        log_write(LOG_DRA_GROUP, g->tx_freq / 10000, g->tx_freq % 10000,
+                  g->rx_freq / 10000, g->rx_freq % 10000, g->squelch);
+        return;
+    } else if (strncmp(cmd, "$DRA,", 5) == 0) {
+        DRA_HandleCommand(cmd + 5);
+        return;
+    } else if (strcmp(cmd, "$BENCH") == 0) {
+        /* Uses the modulator FIFO - only while the radio is idle */
+        if (radio_state == RADIO_IDLE) {
+            bench_Framing(log_text);
+            return;
+        }
+    }
+    log_write(LOG_UNKNOWN_CMD);
+}
+
+/* TIM3 ISR timing since the last report, then start a new window */
+static void Tick_Report(void)
+{
+    static tickstat_t t;
+    const uint32_t *h;
+
+    tickstat_snapshot(&t, 1);
+    log_write(LOG_TICK_INTERVAL, t.intervals, t.int_min,
+              t.intervals ? (uint32_t)(t.int_sum / t.intervals) : 0UL, t.int_max, t.nominal);
+    log_write(LOG_TICK_EXEC, t.ticks, t.exec_min,
+              t.ticks ? (uint32_t)(t.exec_sum / t.ticks) : 0UL, t.exec_max);
+    h = t.int_hist;
+    log_write(LOG_TICK_HIST, "Interval", h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+              h[8], h[9], h[10], h[11], h[12], h[13], h[14], h[15]);
+    h = t.exec_hist;
+    log_write(LOG_TICK_HIST, "ISR", h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+              h[8], h[9], h[10], h[11], h[12], h[13], h[14], h[15]);
+}
+
+/* Sample clock self-test: the TIM3 rate measured over the current
+ * $TICKSTAT window (DWT cycles, so relative to the core clock) against the
+ * modem profile, and the error a rounded period would have
+ */
+static void Rate_Report(void)
+{
+    static tickstat_t t;
+    uint32_t rate = tim3_frac.rate;
+    uint32_t rounded = (tim3_frac.tim_clk + rate / 2) / rate;
+
+    tickstat_snapshot(&t, 0);
+    uint64_t n = t.intervals, cycles = t.int_sum;
+    while (n > 1000000U) {
+        n >>= 1;
+        cycles >>= 1;
+    }
+    uint32_t mhz = cycles ? (uint32_t)(n * HAL_RCC_GetHCLKFreq() * 1000U / cycles) : 0;
+
+    log_write(LOG_RATE, rate, tim3_frac.base, tim3_frac.rem, rate, mhz,
+              (long)(((int64_t)mhz - (int64_t)rate * 1000) * 1000 / rate),
+              (long)(((int64_t)tim3_frac.tim_clk - (int64_t)rounded * rate) * 1000000
+                     / ((int64_t)rounded * rate)));
+}
+
+/* Health counters: the status line goes back to the OBC, each counter
+ * by name to the debug log
+ */
+static void Stats_Report(void)
+{
+    char line[RS485_TX_MAX];
+
+    if (stats_format(line, sizeof(line), HAL_GetTick() / 1000) < 0) return;
+    RS485_Send(line);
+    for (int i = 0; i < STAT_COUNT; i++) {
+        log_write(LOG_STAT, stats_names[i], stats[i]);
+    }
+}
+
+/* Queue the health counters as an APRS status frame every stats_interval_ms */
+static void Stats_Poll(void)
+{
+    char payload[SCHED_MAX_PAYLOAD + 1];
+    uint32_t now = HAL_GetTick();
+
+    if (stats_interval_ms == 0 || now - stats_tick < stats_interval_ms) return;
+    stats_tick = now;
+    payload[0] = '>';
+    if (stats_format(payload + 1, sizeof(payload) - 1, now / 1000) < 0) return;
+    Radio_Queue(SCHED_TELEMETRY, payload);
+}
+
+/* Time spent in WFI and Stop and the Stop wake latency since the last
+ * report, then start a new window
+ */
+static void Idle_Report(void)
+{
+    const idle_stats_t *s = idle_stats();
+
+    log_write(LOG_IDLE, HAL_GetTick() - s->window_tick, (uint32_t)(s->sleep_us / 1000),
+              s->sleeps, s->stop_ms, s->stops, s->rs485_wakes);
+    log_write(LOG_IDLE_WAKE, s->lat_n, s->lat_n ? s->lat_min_us : 0UL,
+              s->lat_n ? (uint32_t)(s->lat_sum_us / s->lat_n) : 0UL, s->lat_max_us, s->rtc_hz);
+    idle_resetStats();
+}
+
+/* Milliseconds until the next frame the main loop queues by itself */
+static uint32_t Idle_NextDueMs(uint32_t now)
+{
+    uint32_t due = BEACON_INTERVAL_MS - (now - beacon_tick);
+
+    if (now - beacon_tick >= BEACON_INTERVAL_MS) return 0;
+    if (stats_interval_ms) {
+        if (now - stats_tick >= stats_interval_ms) return 0;
+        if (stats_interval_ms - (now - stats_tick) < due) {
+            due = stats_interval_ms - (now - stats_tick);
+        }
+    }
+    return due;
+}
+
+/* Sleep until the next interrupt. Every piece of main-loop work is started
+ * by an interrupt or a SysTick deadline, so WFI never delays it by more
+ * than a millisecond. Stop only once the modem is quiet: nothing queued,
+ * no frame on air, the log and the RS485 reply sent, and not on the PLL
+ * (Stop falls back to HSI).
+ */
+static void Idle_Poll(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    if (radio_state != RADIO_IDLE) idle_active_tick = now;
+
+    uint8_t quiet = idle_stop_after_ms != 0 && now - idle_active_tick >= idle_stop_after_ms
+                    && radio_state == RADIO_IDLE && status_batch.count == 0 && !dra_busy()
+                    && log_idle() && huart1.gState == HAL_UART_STATE_READY
+                    && __HAL_UART_GET_FLAG(&huart2, UART_FLAG_TC)
+                    && !clock_profileInfo(clock_getProfile())->pll;
+    for (int c = 0; quiet && c < SCHED_CLASS_COUNT; c++) {
+        if (sched_pending((sched_class_t)c)) quiet = 0;
+    }
+
+    uint32_t due = quiet ? Idle_NextDueMs(now) : 0;
+    if (due >= IDLE_STOP_MIN_MS && rs485_tail == rs485_head) {
+        trace_event(TRACE_STOP_IN, 0);
+        idle_wake_t why = idle_stop(due);
+        trace_event(TRACE_STOP_OUT, (uint8_t)why);
+        if (why == IDLE_WAKE_RS485) {
+            rs485_wake_tick = HAL_GetTick();
+            rs485_wake_guard = 1;
+            idle_active_tick = rs485_wake_tick;
+        }
+        if (why != IDLE_WAKE_SKIPPED) return;
+    }
+
+    __disable_irq();
+    if (rs485_tail == rs485_head) idle_sleep();
+    __enable_irq();
+}
+
+/* Queue one APRS information field for the radio */
+static void Radio_Queue(sched_class_t cls, const char *payload)
+{
+    if (sched_push(cls, payload, HAL_GetTick()) != 0) {
+        log_write(LOG_QUEUE_FULL);
+    }
+}
+
+/* Render every fixed frame (beacon, telemetry definitions) with the
+ * current framing. Only while the radio is idle - a cached stream may be
+ * playing otherwise.
+ */
+static void TxCache_Build(void)
+{
+    uint8_t n = 0;
+
+    tx_cache_count = 0;
+    for (int i = -1; i < APRS_TLM_DEF_COUNT && n < TX_CACHE_SLOTS; i++) {
+        tx_cache_t *c = &tx_cache[n];
+        if (i < 0) {
+            snprintf(c->payload, sizeof(c->payload), "%s", BEACON_TEXT);
+        } else if (APRS_FormatTelemetryDef(c->payload, sizeof(c->payload), SRC_CALL, SRC_SSID,
+                                           (aprs_tlm_def_t)i, tlm_defs()) < 0) {
+            continue;
+        }
+        c->stream.bits = c->bits;
+        c->stream.size = sizeof(c->bits);
+        if (Radio_Frame(c->payload, &c->stream) == 0) n++;
+    }
+    tx_cache_count = n;
+    tx_cache_dirty = 0;
+}
+
+static const afsk_stream_t *TxCache_Find(const char *payload)
+{
+    for (uint8_t i = 0; i < tx_cache_count; i++) {
+        if (strcmp(tx_cache[i].payload, payload) == 0) return &tx_cache[i].stream;
+    }
+    return NULL;
+}
+
+/* Frame one APRS information field with the active framing (IL2P or
+ * FX.25 when enabled and the frame fits, plain AX.25 otherwise) into the
+ * AFSK FIFO, or render it into s when s != NULL
+ */
+static int Radio_Frame(const char *payload, afsk_stream_t *s)
+{
+    /* prepare AX.25 frame */
+    ax25_len = 0;
+    ax25_encode(ax25_buffer, &ax25_len,
+                SRC_CALL, SRC_SSID,
+                DST_CALL, DST_SSID,
+                PATH1_CALL, PATH1_SSID,
+                PATH2_CALL, PATH2_SSID,
+                payload);
+
+    uint16_t il2p_len = il2p_enabled ?
+        il2p_encode(ax25_buffer, ax25_len, il2p_buffer, sizeof(il2p_buffer)) : 0;
+    uint16_t fx25_len = (!il2p_len && fx25_check_bytes) ?
+        fx25_encode(ax25_buffer, ax25_len, fx25_check_bytes, fx25_buffer) : 0;
+    if (s) {
+        if (il2p_len) return afsk_renderRaw(il2p_buffer, il2p_len, AFSK_RAW_IL2P, s);
+        if (fx25_len) return afsk_renderRaw(fx25_buffer, fx25_len, AFSK_RAW_HDLC, s);
+        return afsk_render(ax25_buffer, ax25_len, s);
+    }
+
+    if (il2p_len) {
+        afsk_generateRaw(il2p_buffer, il2p_len, AFSK_RAW_IL2P);
+    } else if (fx25_len) {
+        afsk_generateRaw(fx25_buffer, fx25_len, AFSK_RAW_HDLC);
+    } else {
+        afsk_generate(ax25_buffer, ax25_len);
+    }
+    return 0;
+}
+
+/* Load the modulator for one APRS information field: a pre-rendered
+ * stream if the payload is cached, otherwise framed now
+ */
+static void Radio_Prepare(const char *payload)
+{
+    const afsk_stream_t *cached = TxCache_Find(payload);
+    if (cached) {
+        afsk_play(cached);
+        log_write(LOG_PRERENDERED, cached->nbits);
+        return;
+    }
+
+    Radio_Frame(payload, NULL);
+
+    log_write(LOG_AX25_FRAME, ax25_len, (unsigned)strlen(payload));
+
+    /* Debug: show bit count */
+    log_write(LOG_AFSK_QUEUED, afsk_getBitsRemaining());
+}
+
+/* Keyed time for a queued payload, for the TX budget: TXD and tail plus
+ * the bits of the framing in use (stuffing worst case for AX.25, a full
+ * RS block for FX.25, IL2P_MAX_OUT() unstuffed for IL2P). The real keyed
+ * time is charged afterwards.
+ */
+static uint32_t Radio_EstimateKeyMs(uint16_t payload_len)
+{
+    uint32_t frame = payload_len + AX25_ADDR_LEN * (2 + AX25_MAX_REPEATERS) + 2 + AX25_FCS_LEN;
+    uint32_t bits;
+
+    if (il2p_enabled && frame <= IL2P_MAX_PAYLOAD) {
+        bits = IL2P_MAX_OUT(frame) * 8;
+    } else {
+        bits = frame * 8 * 6 / 5;
+        if (fx25_check_bytes && bits < FX25_MAX_OUT * 8) bits = FX25_MAX_OUT * 8;
+    }
+    bits += (afsk_getPreambleFlags() + AFSK_TAIL_FLAGS) * 8;
+
+    return RADIO_TXD_MS + RADIO_TAIL_MS + bits * 1000 / afsk_getProfile()->baud;
+}
+
+/* Radio state machine, run from the main loop:
+ * IDLE -> (pre-TX delay) -> PTT on -> (TXD) -> modulate -> (tail) -> PTT off
+ * The next frame is taken from the scheduler only once the radio is idle,
+ * so RS485 input keeps being handled while a frame is on air.
+ */
+static void Radio_Poll(void)
+{
+    static char payload[SCHED_MAX_PAYLOAD + 1];
+    uint32_t now = HAL_GetTick();
+
+    switch (radio_state) {
+    case RADIO_IDLE: {
+        uint16_t len;
+        TIM3_Run(0);
+        if (tx_cache_dirty) TxCache_Build();
+        if (sched_peek(&len, now) < 0) {
+            Clock_Select(clock_idle);
+            break;
+        }
+        /* Not while the radio is being configured */
+        if (dra_busy()) break;
+
+        /* Over budget: the frame stays queued until the buckets refill */
+        uint32_t key_ms = Radio_EstimateKeyMs(len);
+        uint8_t was_deferring = txgov_state()->deferring;
+        if (!txgov_allow(key_ms, now)) {
+            if (!was_deferring) {
+                stats_inc(STAT_DEFERRED);
+                log_write(LOG_TX_DEFERRED, txgov_waitMs(key_ms));
+            }
+            break;
+        }
+
+        sched_pop(payload, sizeof(payload), now);
+        radio_state = RADIO_PRE_TX;
+        radio_tick = now;
+        break;
+    }
+
+    case RADIO_PRE_TX:
+        /* Pre-TX delay - system stabilization; the clock goes up for the
+         * encode. A refused switch is retried; after RADIO_CLOCK_WAIT_MS
+         * the frame is encoded on the clock it has, and that is counted.
+         */
+        if (Clock_Select(clock_burst) != 0) {
+            if (now - radio_tick < RADIO_CLOCK_WAIT_MS) break;
+            stats_inc(STAT_CLOCK_FALLBACK);
+            log_write(LOG_CLOCK_FALLBACK, now - radio_tick,
+                      clock_profileInfo(clock_getProfile())->name);
+        }
+        TIM3_Run(1);
+        if (now - radio_tick < RADIO_PRE_TX_MS) break;
+        Radio_Prepare(payload);
+        /* Enable PTT */
+        HAL_GPIO_WritePin(PTT_UHF_GPIO_Port, PTT_UHF_Pin, GPIO_PIN_SET);
+        trace_event(TRACE_PTT_ON, 0);
+        log_write(LOG_PTT_ON);
+        radio_state = RADIO_TXD;
+        radio_tick = now;
+        radio_key_tick = now;
+        break;
+
+    case RADIO_TXD:
+        /* TX Delay (TXD) - wait for radio to key up
+         * DRA818U typically needs 300-500ms
+         * The frame is encoded: playing it does not need the burst clock,
+         * so drop back now (retried through TXD, no-op once done).
+         */
+        Clock_Select(clock_idle);
+        if (now - radio_tick < RADIO_TXD_MS) break;
+        afsk_start();
+        log_write(LOG_TX_STARTED);
+        radio_state = RADIO_ON_AIR;
+        radio_tick = now;
+        break;
+
+    case RADIO_ON_AIR:
+        if (afsk_isBusy()) {
+            if (now - radio_tick <= RADIO_TX_TIMEOUT_MS) break;
+            stats_inc(STAT_TIMEOUTS);
+            log_write(LOG_TX_TIMEOUT);
+        } else {
+            stats_inc(STAT_FRAMES);
+        }
+        log_write(LOG_TX_COMPLETE, now - radio_tick);
+        radio_state = RADIO_TAIL;
+        radio_tick = now;
+        break;
+
+    case RADIO_TAIL:
+        /* Post-TX delay before releasing PTT */
+        if (now - radio_tick < RADIO_TAIL_MS) break;
+        /* Stop AFSK and release PTT */
+        afsk_stop();
+        HAL_GPIO_WritePin(PTT_UHF_GPIO_Port, PTT_UHF_Pin, GPIO_PIN_RESET);
+        trace_event(TRACE_PTT_OFF, 0);
+        log_write(LOG_PTT_OFF);
+        txgov_charge(now - radio_key_tick, now);
+        stats_add(STAT_AIRTIME_MS, now - radio_key_tick);
+        radio_state = RADIO_IDLE;
+        break;
+    }
+}
+
+/* Queue the identification beacon every BEACON_INTERVAL_MS */
+static void Beacon_Poll(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    if (now - beacon_tick < BEACON_INTERVAL_MS) return;
+    beacon_tick = now;
+    if (sched_pending(SCHED_BEACON) == 0) Radio_Queue(SCHED_BEACON, BEACON_TEXT);
+}
+
+/* Queue a telemetry line for the next status frame.
+ * Build APRS payload with Data Type Identifier
+ * '>' = Status message (most appropriate for telemetry)
+ * Format: >line^line^... | Somaiya OrbitRadio-5 73
+ */
+static void Status_Queue(const char *line)
+{
+    uint32_t now = HAL_GetTick();
+
+    if (1 + strlen(line) + strlen(STATUS_SUFFIX) > BATCH_MAX_PAYLOAD) {
+        /* Keep frame order: what is queued goes first */
+        Status_Flush();
+        Status_SendFragmented(line);
+        return;
+    }
+
+    if (batch_add(&status_batch, line, now) != 0) {
+        /* Full: send what is queued, the line starts the next frame */
+        Status_Flush();
+        batch_add(&status_batch, line, now);
+    }
+    if (batch_window_ms == 0) Status_Flush();
+}
+
+static void Status_Flush(void)
+{
+    if (status_batch.count == 0) return;
+
+    log_write(LOG_BATCH, status_batch.count);
+
+    Radio_Queue(SCHED_TELEMETRY, batch_payload(&status_batch));
+    batch_clear(&status_batch);
+}
+
+/* Send a line too long for one frame as numbered fragments */
+static void Status_SendFragmented(const char *line)
+{
+    static char body[LINE_BUF_SIZE + sizeof(STATUS_SUFFIX)];
+    char payload[BATCH_MAX_PAYLOAD + 1];
+    frag_t f;
+
+    snprintf(body, sizeof(body), "%s%s", line, STATUS_SUFFIX);
+    if (frag_Begin(&f, body, (uint16_t)strlen(body), BATCH_MAX_PAYLOAD, frag_id) < 0) {
+        stats_inc(STAT_LINES_DROPPED);
+        log_write(LOG_FRAG_TOO_LONG);
+        return;
+    }
+    /* A partly queued record cannot be reassembled: all fragments or none */
+    if (sched_room(SCHED_TELEMETRY) < f.count) {
+        stats_inc(STAT_LINES_DROPPED);
+        log_write(LOG_FRAG_NO_ROOM, f.count);
+        return;
+    }
+    frag_id++;
+
+    log_write(LOG_FRAG, f.count);
+
+    while (frag_next(&f, payload, sizeof(payload)) > 0) {
+        Radio_Queue(SCHED_TELEMETRY, payload);
+    }
+}
+
+/* Decode a binary housekeeping record and send what changed (periodically
+ * the full compressed APRS telemetry), followed by a definition frame when
+ * one is due
+ */
+static void Telemetry_Send(const uint8_t *rec, uint16_t len)
+{
+    char payload[256];
+
+    if (tlm_decode(rec, len) != 0) {
+        stats_inc(STAT_OBC_ERRORS);
+        log_write(LOG_OBC_BAD_RECORD);
+        return;
+    }
+
+    int n = tlm_formatDelta(payload, sizeof(payload), tlm_seq);
+    if (n == 0) {
+        log_write(LOG_TLM_NO_CHANGE);
+        return;
+    }
+    if (n < 0) {
+        tlm_forceRefresh();
+        return;
+    }
+    tlm_seq = (uint16_t)((tlm_seq + 1) % (APRS_TLM_B91_MAX + 1));
+
+    log_write(LOG_TLM, payload);
+    Radio_Queue(tlm_isAlarm() ? SCHED_ALARM : SCHED_TELEMETRY, payload);
+
+    int def = APRS_NextTelemetryDef();
+    if (def >= 0 && APRS_FormatTelemetryDef(payload, sizeof(payload), SRC_CALL, SRC_SSID,
+                                            (aprs_tlm_def_t)def, tlm_defs()) > 0) {
+        Radio_Queue(SCHED_DEFS, payload);
+    }
+}
+
+/* Next byte from the RS485 receive ring */
+static uint8_t RS485_ReadByte(uint8_t *b)
+{
+    if (rs485_tail == rs485_head) return 0;
+    *b = rs485_ring[rs485_tail];
+    rs485_tail = (uint16_t)((rs485_tail + 1) % RS485_RX_RING);
+    return 1;
+}
+
+/* USART1 receive complete: store the byte and re-arm */
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART6) {
+        dra_rxDone(huart);
+        return;
+    }
+    if (huart->Instance != USART1) return;
+    rs485_rx_tick = HAL_GetTick();
+
+    /* Left over from the start bit that ended a Stop */
+    if (rs485_wake_guard) {
+        if (HAL_GetTick() - rs485_wake_tick < RS485_WAKE_GUARD_MS) {
+            HAL_UART_Receive_IT(&huart1, &rs485_rx_byte, 1);
+            return;
+        }
+        rs485_wake_guard = 0;
+    }
+
+    uint16_t next = (uint16_t)((rs485_head + 1) % RS485_RX_RING);
+    if (next != rs485_tail) {
+        rs485_ring[rs485_head] = rs485_rx_byte;
+        rs485_head = next;
+    } else {
+        stats_inc(STAT_RS485_OVERRUNS);
+    }
+    HAL_UART_Receive_IT(&huart1, &rs485_rx_byte, 1);
+}
+
+/* Framing/noise/overrun errors abort the transfer - start listening again */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART6) {
+        dra_rxError(huart);
+        return;
+    }
+    if (huart->Instance != USART1) return;
+    stats_inc(STAT_RS485_ERRORS);
+    HAL_UART_Receive_IT(&huart1, &rs485_rx_byte, 1);
+}
+
+/* One byte from the RS485 line: binary record, command or telemetry line */
+static void RS485_HandleByte(uint8_t b)
+{
+    HAL_GPIO_TogglePin(LD2_GPIO_Port, LD2_Pin);
+    idle_active_tick = HAL_GetTick();
+
+    /* Binary OBC records are COBS frames between zero bytes */
+    obc_rx_t rx = obc_link_rx(&obc_link, b);
+    if (rx != OBC_RX_TEXT) {
+        if (b == 0) rs485_len = 0;
+        RS485_HandleLink(rx);
+        return;
+    }
+    RS485_HandleText(b);
+}
+
+/* Outcome of the binary receiver: a record, a bad frame, or bytes that a
+ * stray zero had taken for a frame and that go back to the text path
+ */
+static void RS485_HandleLink(obc_rx_t rx)
+{
+    if (rx == OBC_RX_RECORD) {
+        Telemetry_Send(obc_link.rec, obc_link.rec_len);
+    } else if (rx == OBC_RX_ERROR) {
+        stats_inc(STAT_OBC_ERRORS);
+        log_write(LOG_OBC_BAD_FRAME);
+    } else if (rx == OBC_RX_REPLAY) {
+        log_write(LOG_OBC_REPLAY, obc_link.text_len);
+        for (uint16_t i = 0; i < obc_link.text_len; i++) {
+            RS485_HandleText(obc_link.text[i]);
+        }
+    }
+}
+
+/* One byte of a text line: command or telemetry */
+static void RS485_HandleText(uint8_t b)
+{
+    if (b == '\r') return;
+    if (b == '\n' && rs485_len == 0) return;   /* also the OBC's wake byte */
+    if (b == '\n' || rs485_len >= (LINE_BUF_SIZE - 2))
+    {
+        rs485_msg[rs485_len] = '\0';
+
+        /* '$' lines are modem commands from the OBC, not telemetry */
+        if (rs485_msg[0] == '$') {
+            RS485_HandleCommand(rs485_msg);
+            rs485_len = 0;
+            memset(rs485_msg, 0, sizeof(rs485_msg));
+            return;
+        }
+
+        log_write(LOG_RS485_LINE, rs485_msg);
+
+        if (rs485_msg[0] == ALARM_PREFIX) {
+            char payload[SCHED_MAX_PAYLOAD + 1];
+            snprintf(payload, sizeof(payload), ">%s%s", rs485_msg, STATUS_SUFFIX);
+            Radio_Queue(SCHED_ALARM, payload);
+        } else {
+            Status_Queue(rs485_msg);
+        }
+
+        /* Clear receive buffer */
+        rs485_len = 0;
+        memset(rs485_msg, 0, sizeof(rs485_msg));
+    }
+    else
+    {
+        rs485_msg[rs485_len++] = (char)b;
+    }
+}
+
 /* RS485 receive mode */
 static void RS485_SetReceive(void)
 {
@@ -448,35 +1480,104 @@ static void RS485_SetReceive(void)
     HAL_GPIO_WritePin(RS485_DE_GPIO_Port, RS485_DE_Pin, GPIO_PIN_RESET);
 }
 
-/* Debug print */
-static void Debug_Print(const char *s)
+/* RS485 transmit mode: driver on, receiver off (no echo of our own reply) */
+static void RS485_SetTransmit(void)
 {
-    HAL_UART_Transmit(&huart2, (uint8_t*)s, strlen(s), HAL_MAX_DELAY);
+    HAL_GPIO_WritePin(RS485_RE_GPIO_Port, RS485_RE_Pin, GPIO_PIN_SET);
+    HAL_GPIO_WritePin(RS485_DE_GPIO_Port, RS485_DE_Pin, GPIO_PIN_SET);
 }
 
-/* DRA818U helpers */
-void DRA_Send(const char *s)
+/* Reply line to the OBC. Sent by interrupt; the bus goes back to receive
+ * from the TX complete callback, after the last stop bit. Returns -1 while
+ * the previous reply is still going out.
+ */
+static int RS485_Send(const char *line)
 {
-    HAL_UART_Transmit(&huart6, (uint8_t*)s, strlen(s), HAL_MAX_DELAY);
-    HAL_UART_Transmit(&huart6, (uint8_t*)"\r\n", 2, HAL_MAX_DELAY);
+    if (huart1.gState != HAL_UART_STATE_READY) return -1;
+
+    int n = snprintf(rs485_tx, sizeof(rs485_tx), "%s\r\n", line);
+    if (n < 0 || (size_t)n >= sizeof(rs485_tx)) return -1;
+
+    HAL_HalfDuplex_EnableTransmitter(&huart1);
+    RS485_SetTransmit();
+    if (HAL_UART_Transmit_IT(&huart1, (uint8_t *)rs485_tx, (uint16_t)n) != HAL_OK) {
+        HAL_HalfDuplex_EnableReceiver(&huart1);
+        RS485_SetReceive();
+        return -1;
+    }
+    return 0;
 }
 
-void DRA_Init(void)
+/* Debug log DMA done, or an RS485 reply sent */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
 {
-    Debug_Print("Configuring DRA818U...\r\n");
-    HAL_Delay(500);
-
-    DRA_Send("AT+DMOCONNECT");
-    HAL_Delay(300);
+    if (huart->Instance == USART1) {
+        HAL_HalfDuplex_EnableReceiver(&huart1);
+        RS485_SetReceive();
+        return;
+    }
+    log_txDone(huart);
+}
 
-    /* 435.2480 MHz, no CTCSS, squelch 0 */
-    DRA_Send("AT+DMOSETGROUP=0,435.2480,435.2480,0000,0,0000");
-    HAL_Delay(300);
+/* DRA818U: queue the boot configuration; the driver sends it as soon as
+ * the module answers, frames wait until it is done
+ */
+static void DRA_Init(void)
+{
+    const dra_group_t g = { DRA_FREQ, DRA_FREQ, 0, 0, 0, 0 };
+
+    log_write(LOG_DRA_CONFIG);
+    dra_Init(&huart6);
+    dra_connect();
+    dra_setGroup(&g);
+    dra_setVolume(DRA_VOLUME);
+    dra_booting = 1;
+}
 
-    DRA_Send("AT+DMOSETVOLUME=8");
-    HAL_Delay(200);
+static void DRA_Poll(void)
+{
+    dra_event_t ev = dra_Poll(HAL_GetTick());
+    const dra_result_t *r = dra_result();
+
+    if (ev == DRA_EV_OK) {
+        log_write(LOG_DRA_OK, r->name, r->tries, r->ms);
+    } else if (ev == DRA_EV_FAILED) {
+        stats_inc(STAT_DRA_ERRORS);
+        log_write(LOG_DRA_FAILED, r->name, r->tries);
+        dra_boot_failed |= dra_booting;
+    }
+    if (ev != DRA_EV_NONE && dra_booting && !dra_busy()) {
+        dra_booting = 0;
+        if (!dra_boot_failed) log_write(LOG_DRA_READY);
+    }
+}
 
-    Debug_Print("DRA818U @ 435.2480 MHz ready\r\n");
+/* "$DRA,..." arguments; the settings apply once the module acknowledges */
+static void DRA_HandleCommand(const char *args)
+{
+    dra_group_t g = *dra_group();
+    int rc = -1;
+
+    if (strncmp(args, "FREQ,", 5) == 0) {
+        const char *rx = strchr(args + 5, ',');
+        if (dra_parseFreq(args + 5, &g.tx_freq) == 0) {
+            g.rx_freq = g.tx_freq;
+            if (!rx || dra_parseFreq(rx + 1, &g.rx_freq) == 0) rc = dra_setGroup(&g);
+        }
+    } else if (strncmp(args, "SQ,", 3) == 0) {
+        g.squelch = (uint8_t)strtoul(args + 3, NULL, 10);
+        rc = dra_setGroup(&g);
+    } else if (strncmp(args, "VOL,", 4) == 0) {
+        rc = dra_setVolume((uint8_t)strtoul(args + 4, NULL, 10));
+    } else if (strncmp(args, "FILTER,", 7) == 0) {
+        char *end;
+        unsigned long e = strtoul(args + 7, &end, 10);
+        if (*end == ',') {
+            unsigned long h = strtoul(end + 1, &end, 10);
+            if (*end == ',') rc = dra_setFilter((uint8_t)e, (uint8_t)h, (uint8_t)strtoul(end + 1, NULL, 10));
+        }
+    }
+    if (rc != 0) log_write(LOG_UNKNOWN_CMD);
 }
 
 /* Error handler */
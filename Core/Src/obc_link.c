@@ -0,0 +1,109 @@
+/* obc_link.c
+ * Binary OBC records on the RS-485 line: COBS framing + CRC-16
+ */
+
+#include "obc_link.h"
+#include "ax25.h"
+#include <string.h>
+
+void obc_link_Init(obc_link_t *l)
+{
+    memset(l, 0, sizeof(*l));
+}
+
+int obc_link_cobsDecode(const uint8_t *in, uint16_t len, uint8_t *out)
+{
+    uint16_t i = 0, o = 0;
+
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || (uint16_t)(i + code - 1) > len) return -1;
+
+        for (uint8_t k = 1; k < code; k++) {
+            out[o++] = in[i++];
+        }
+        /* A block shorter than 255 stands for a zero, except at the end */
+        if (code != 0xFF && i < len) out[o++] = 0;
+    }
+    return o;
+}
+
+/* Printable ASCII and line ends only */
+static uint8_t is_text(const uint8_t *p, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; i++) {
+        if ((p[i] < 0x20 || p[i] > 0x7E) && p[i] != '\r' && p[i] != '\n' && p[i] != '\t') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Drop the frame being received; stay binary if the zero that ended it
+ * may open the next one
+ */
+static obc_rx_t give_up(obc_link_t *l, uint8_t stay_binary)
+{
+    obc_rx_t rx = OBC_RX_ERROR;
+
+    if (is_text(l->buf, l->len)) {
+        memcpy(l->text, l->buf, l->len);
+        l->text_len = l->len;
+        rx = OBC_RX_REPLAY;
+    } else {
+        l->frames_bad++;
+    }
+    l->binary = stay_binary;
+    l->len = 0;
+    return rx;
+}
+
+obc_rx_t obc_link_rx(obc_link_t *l, uint8_t b)
+{
+    if (b != 0) {
+        if (!l->binary) return OBC_RX_TEXT;
+        if (l->len < sizeof(l->buf)) {
+            l->buf[l->len++] = b;
+            return OBC_RX_PENDING;
+        }
+        /* Longer than any frame: back to text, with this byte */
+        obc_rx_t rx = give_up(l, 0);
+        if (rx == OBC_RX_REPLAY) l->text[l->text_len++] = b;
+        return rx;
+    }
+
+    /* Delimiter: opens a frame in text mode, closes one in binary mode */
+    if (!l->binary || l->len == 0) {
+        l->binary = 1;
+        l->len = 0;
+        return OBC_RX_PENDING;
+    }
+
+    int n = obc_link_cobsDecode(l->buf, l->len, l->rec);
+
+    if (n <= OBC_LINK_CRC_LEN || n - OBC_LINK_CRC_LEN > OBC_LINK_MAX_RECORD) {
+        return give_up(l, 1);
+    }
+
+    uint16_t body = (uint16_t)(n - OBC_LINK_CRC_LEN);
+    uint16_t crc = (uint16_t)(l->rec[body] | (l->rec[body + 1] << 8));
+    if (ax25_fcs(l->rec, body) != crc) {
+        return give_up(l, 1);
+    }
+
+    l->binary = 0;
+    l->len = 0;
+    l->rec_len = body;
+    l->frames_ok++;
+    return OBC_RX_RECORD;
+}
+
+obc_rx_t obc_link_idle(obc_link_t *l)
+{
+    if (!l->binary) return OBC_RX_PENDING;
+    if (l->len == 0) {
+        l->binary = 0;
+        return OBC_RX_PENDING;
+    }
+    return give_up(l, 0);
+}
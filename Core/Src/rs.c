@@ -0,0 +1,81 @@
+/* rs.c
+ * Table-driven Reed-Solomon encoder over GF(256), field polynomial 0x11D.
+ *
+ * Log/antilog tables are built once into RAM; alpha_to[] is doubled so
+ * that the sum of two logs never needs a modulo 255 in the inner loop.
+ */
+
+#include "rs.h"
+#include <string.h>
+
+#define GF_POLY  0x11D
+#define A0       255U            /* log of zero */
+
+static uint8_t alpha_to[2 * 255];
+static uint8_t index_of[256];
+
+void rs_Init(void)
+{
+    uint16_t sr = 1;
+
+    index_of[0] = A0;
+    for (uint16_t i = 0; i < 255; i++) {
+        alpha_to[i] = (uint8_t)sr;
+        alpha_to[i + 255] = (uint8_t)sr;
+        index_of[sr] = (uint8_t)i;
+        sr <<= 1;
+        if (sr & 0x100) sr ^= GF_POLY;
+    }
+}
+
+static uint8_t gf_mul_log(uint8_t a, uint16_t log_b)
+{
+    if (a == 0) return 0;
+    return alpha_to[(index_of[a] + log_b) % 255];
+}
+
+void rs_InitCode(rs_code_t *rs, uint8_t nroots, uint8_t fcr)
+{
+    uint8_t g[RS_MAX_ROOTS + 1];
+
+    if (nroots > RS_MAX_ROOTS) nroots = RS_MAX_ROOTS;
+    rs->nroots = nroots;
+
+    /* g(x) = prod (x - alpha^(fcr+i)) */
+    memset(g, 0, sizeof(g));
+    g[0] = 1;
+    for (uint8_t i = 0; i < nroots; i++) {
+        uint16_t root = (uint16_t)(fcr + i);
+        g[i + 1] = 1;
+        for (uint8_t j = i; j > 0; j--) {
+            g[j] = g[j - 1] ^ gf_mul_log(g[j], root);
+        }
+        g[0] = gf_mul_log(g[0], root);
+    }
+
+    /* Store in index form for the encoder */
+    for (uint8_t i = 0; i <= nroots; i++) {
+        rs->genpoly[i] = index_of[g[i]];
+    }
+}
+
+void rs_encode(const rs_code_t *rs, const uint8_t *data, uint16_t len, uint8_t *parity)
+{
+    const uint8_t nroots = rs->nroots;
+    const uint8_t *gp = rs->genpoly;
+
+    memset(parity, 0, nroots);
+
+    for (uint16_t i = 0; i < len; i++) {
+        uint8_t fb = index_of[data[i] ^ parity[0]];
+
+        if (fb != A0) {
+            for (uint8_t j = 1; j < nroots; j++) {
+                parity[j] ^= alpha_to[fb + gp[nroots - j]];
+            }
+        }
+
+        memmove(&parity[0], &parity[1], nroots - 1);
+        parity[nroots - 1] = (fb != A0) ? alpha_to[fb + gp[0]] : 0;
+    }
+}
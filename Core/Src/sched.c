@@ -0,0 +1,157 @@
+/* sched.c
+ * Priority-class scheduler for outgoing APRS frames
+ *
+ * Frames wait in a shared slot pool tagged with their class. Urgent
+ * classes go first; the rate limit keeps one class from hogging the
+ * channel, and aging lets long-waiting low classes through eventually.
+ */
+
+#include "sched.h"
+#include "stats.h"
+#include "trace.h"
+#include <string.h>
+
+static const sched_class_cfg_t class_cfg[SCHED_CLASS_COUNT] = {
+    /* name          min_interval_ms  aging_ms */
+    { "alarm",                     0,         0 },
+    { "telemetry",              1000,     30000 },
+    { "beacon",                60000,     60000 },
+    { "defs",                  20000,    120000 },
+};
+
+typedef struct {
+    uint8_t  used;
+    uint8_t  cls;
+    uint32_t queued_tick;
+    uint32_t order;
+    char     payload[SCHED_MAX_PAYLOAD + 1];
+} sched_slot_t;
+
+static sched_slot_t slots[SCHED_SLOTS];
+static uint32_t next_order;
+static uint32_t last_sent[SCHED_CLASS_COUNT];
+static uint8_t sent_any[SCHED_CLASS_COUNT];
+
+void sched_Init(void)
+{
+    memset(slots, 0, sizeof(slots));
+    memset(sent_any, 0, sizeof(sent_any));
+    next_order = 0;
+}
+
+int sched_push(sched_class_t cls, const char *payload, uint32_t now)
+{
+    sched_slot_t *s = NULL;
+    uint8_t used = 1;
+
+    if (cls >= SCHED_CLASS_COUNT) return -1;
+
+    for (uint8_t i = 0; i < SCHED_SLOTS; i++) {
+        if (slots[i].used) used++;
+        else if (!s) s = &slots[i];
+    }
+
+    if (!s) {
+        /* Evict the oldest frame of the lowest class below this one */
+        for (uint8_t i = 0; i < SCHED_SLOTS; i++) {
+            sched_slot_t *c = &slots[i];
+            if (c->cls <= cls) continue;
+            if (!s || c->cls > s->cls || (c->cls == s->cls && c->order < s->order)) s = c;
+        }
+        if (!s) {
+            trace_event(TRACE_Q_FULL, (uint8_t)cls);
+            stats_inc(STAT_QUEUE_FULL);
+            return -1;
+        }
+        trace_event(TRACE_Q_EVICT, s->cls);
+        stats_inc(STAT_QUEUE_EVICTED);
+        used = SCHED_SLOTS;
+    }
+
+    s->used = 1;
+    s->cls = (uint8_t)cls;
+    s->queued_tick = now;
+    s->order = next_order++;
+    strncpy(s->payload, payload, SCHED_MAX_PAYLOAD);
+    s->payload[SCHED_MAX_PAYLOAD] = 0;
+    trace_event(TRACE_Q_PUSH, (uint8_t)cls);
+    stats_peak(STAT_QUEUE_PEAK, used);
+    return 0;
+}
+
+static uint8_t class_allowed(uint8_t cls, uint32_t now)
+{
+    return !sent_any[cls] || (now - last_sent[cls]) >= class_cfg[cls].min_interval_ms;
+}
+
+static uint32_t effective_class(const sched_slot_t *s, uint32_t now)
+{
+    uint32_t aging = class_cfg[s->cls].aging_ms;
+    uint32_t raise = aging ? (now - s->queued_tick) / aging : 0;
+    return (raise >= s->cls) ? 0 : s->cls - raise;
+}
+
+static sched_slot_t *select_next(uint32_t now)
+{
+    sched_slot_t *best = NULL;
+    uint32_t best_prio = 0;
+
+    for (uint8_t i = 0; i < SCHED_SLOTS; i++) {
+        sched_slot_t *s = &slots[i];
+        if (!s->used || !class_allowed(s->cls, now)) continue;
+
+        uint32_t prio = effective_class(s, now);
+        if (!best || prio < best_prio ||
+            (prio == best_prio && (s->cls < best->cls ||
+                                   (s->cls == best->cls && s->order < best->order)))) {
+            best = s;
+            best_prio = prio;
+        }
+    }
+    return best;
+}
+
+int sched_peek(uint16_t *len, uint32_t now)
+{
+    sched_slot_t *best = select_next(now);
+    if (!best) return -1;
+    if (len) *len = (uint16_t)strlen(best->payload);
+    return best->cls;
+}
+
+int sched_pop(char *out, size_t size, uint32_t now)
+{
+    sched_slot_t *best = select_next(now);
+    if (!best || size == 0) return -1;
+
+    strncpy(out, best->payload, size - 1);
+    out[size - 1] = 0;
+    best->used = 0;
+    last_sent[best->cls] = now;
+    sent_any[best->cls] = 1;
+    trace_event(TRACE_Q_POP, best->cls);
+    return best->cls;
+}
+
+uint8_t sched_pending(sched_class_t cls)
+{
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < SCHED_SLOTS; i++) {
+        if (slots[i].used && slots[i].cls == cls) n++;
+    }
+    return n;
+}
+
+uint8_t sched_room(sched_class_t cls)
+{
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < SCHED_SLOTS; i++) {
+        if (!slots[i].used || slots[i].cls > cls) n++;
+    }
+    return n;
+}
+
+const sched_class_cfg_t *sched_classCfg(sched_class_t cls)
+{
+    return (cls < SCHED_CLASS_COUNT) ? &class_cfg[cls] : NULL;
+}
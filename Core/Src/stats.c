@@ -0,0 +1,27 @@
+/* stats.c
+ * Modem health counters
+ */
+
+#include "stats.h"
+#include <stdio.h>
+
+volatile uint32_t stats[STAT_COUNT];
+
+const char *const stats_names[STAT_COUNT] = {
+#define STATS_NAME(id, name) name,
+    STATS_COUNTERS(STATS_NAME)
+#undef STATS_NAME
+};
+
+int stats_format(char *out, size_t size, uint32_t uptime_s)
+{
+    uint32_t keyed = stats[STAT_FRAMES] + stats[STAT_TIMEOUTS];
+    uint32_t air = stats[STAT_AIRTIME_MS];
+    int n = snprintf(out, size, "STATS,%lu,%lu", (unsigned long)uptime_s,
+                     (unsigned long)(keyed ? air / keyed : 0));
+
+    for (int i = 0; i < STAT_COUNT && n >= 0 && (size_t)n < size; i++) {
+        n += snprintf(out + n, size - n, ",%lu", (unsigned long)stats[i]);
+    }
+    return (n >= 0 && (size_t)n < size) ? n : -1;
+}
@@ -70,7 +70,10 @@ void HAL_MspInit(void)
   __HAL_RCC_SYSCFG_CLK_ENABLE();
   __HAL_RCC_PWR_CLK_ENABLE();
 
-  HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_0);
+  /* 2 bits preemption, 2 bits subpriority: TIM3 (preempt 0) interrupts the
+   * UART and DMA handlers (preempt 1) instead of waiting for them to return
+   */
+  HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_2);
 
   /* System interrupt init*/
 
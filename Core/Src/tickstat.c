@@ -0,0 +1,83 @@
+/* tickstat.c
+ * TIM3 sample ISR timing: inter-sample interval and execution time
+ *
+ * A late tick shows up as a long interval followed by a short one, so
+ * the interval spread is the sample-clock jitter the DAC sees; exec time
+ * shows how much of the period the ISR itself uses.
+ */
+
+#include "tickstat.h"
+#include "dwt.h"
+#include <string.h>
+
+static tickstat_t st;
+static uint32_t entry_cycles;
+static uint32_t last_entry;
+static uint8_t primed;
+
+void tickstat_Reset(uint32_t nominal_cycles)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    dwt_Init();
+    memset(&st, 0, sizeof(st));
+    st.nominal = nominal_cycles;
+    primed = 0;
+    __set_PRIMASK(primask);
+}
+
+void tickstat_restart(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    primed = 0;
+    __set_PRIMASK(primask);
+}
+
+RAMFUNC void tickstat_enter(void)
+{
+    uint32_t now = DWT->CYCCNT;
+    entry_cycles = now;
+
+    if (primed) {
+        uint32_t iv = now - last_entry;
+        if (st.intervals == 0 || iv < st.int_min) st.int_min = iv;
+        if (iv > st.int_max) st.int_max = iv;
+        st.int_sum += iv;
+        st.intervals++;
+
+        int32_t bin = ((int32_t)(iv - st.nominal) + (TICKSTAT_BINS / 2) * TICKSTAT_INT_BIN_CYCLES);
+        bin = (bin < 0) ? 0 : bin / TICKSTAT_INT_BIN_CYCLES;
+        if (bin >= TICKSTAT_BINS) bin = TICKSTAT_BINS - 1;
+        st.int_hist[bin]++;
+    }
+    last_entry = now;
+    primed = 1;
+}
+
+RAMFUNC void tickstat_exit(void)
+{
+    uint32_t ex = DWT->CYCCNT - entry_cycles;
+
+    if (st.ticks == 0 || ex < st.exec_min) st.exec_min = ex;
+    if (ex > st.exec_max) st.exec_max = ex;
+    st.exec_sum += ex;
+    st.ticks++;
+
+    uint32_t bin = ex / TICKSTAT_EXEC_BIN_CYCLES;
+    st.exec_hist[bin < TICKSTAT_BINS ? bin : TICKSTAT_BINS - 1]++;
+}
+
+void tickstat_snapshot(tickstat_t *out, uint8_t reset)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = st;
+    if (reset) {
+        uint32_t nominal = st.nominal;
+        memset(&st, 0, sizeof(st));
+        st.nominal = nominal;
+        primed = 0;
+    }
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,229 @@
+/* tlm.c
+ * Schema-driven OBC telemetry: binary record decode and APRS encoding
+ *
+ * The housekeeping record is the type byte followed by the schema fields
+ * in table order, little-endian. Each field is decoded straight into its
+ * slot; the APRS encoder then sends mapped fields as two base91 digits and
+ * the rest as short text.
+ */
+
+#include "tlm.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Housekeeping record layout. Keep in step with the OBC. */
+static const tlm_field_t tlm_schema[] = {
+    /* name     unit    type     offset  scale  eqns           channel          deadband */
+    { "Vbat",   "V",    TLM_U16,      0,   2,   "0,0.002,0",   0,                 20 },   /* mV */
+    { "Ibat",   "mA",   TLM_I16,  -4000,   1,   "0,1,-4000",   1,                 25 },   /* mA */
+    { "Vsol",   "V",    TLM_U16,      0,   4,   "0,0.004,0",   2,                100 },   /* mV */
+    { "Tobc",   "degC", TLM_I16,   -400,   1,   "0,0.1,-40",   3,                  5 },   /* 0.1 C */
+    { "Tpa",    "degC", TLM_I16,   -400,   1,   "0,0.1,-40",   4,                  5 },   /* 0.1 C */
+    { "Flags",  "",     TLM_U8,       0,   1,   NULL,          TLM_CH_DIGITAL,     0 },
+    { "Uptime", "s",    TLM_U32,      0,   1,   NULL,          TLM_CH_NONE,      600 },
+    { "Resets", "",     TLM_U16,      0,   1,   NULL,          TLM_CH_NONE,        0 },
+};
+#define TLM_FIELDS (sizeof(tlm_schema) / sizeof(tlm_schema[0]))
+
+/* Names of the Flags bits, bit 0 first (APRS B1..B8) */
+static const char *const tlm_bit_names[APRS_TLM_DIGITAL] = {
+    "Safe", "Depl", "Chrg", "Heat", "Adcs", "Tx", "Gps", "Err"
+};
+
+static const uint8_t type_size[] = { 1, 1, 2, 2, 4, 4 };
+
+static tlm_slot_t tlm_slots[TLM_FIELDS];
+static aprs_tlm_defs_t defs;
+
+/* Delta mode: raw values as last sent, records since the last full frame */
+static int64_t tlm_sent[TLM_FIELDS];
+static uint8_t tlm_since_full = TLM_REFRESH_EVERY;
+
+void tlm_Init(void)
+{
+    memset(tlm_slots, 0, sizeof(tlm_slots));
+    memset(&defs, 0, sizeof(defs));
+    tlm_forceRefresh();
+
+    for (uint8_t i = 0; i < TLM_FIELDS; i++) {
+        const tlm_field_t *f = &tlm_schema[i];
+        if (f->channel >= 0 && f->channel < APRS_TLM_ANALOG) {
+            defs.name[f->channel] = f->name;
+            defs.unit[f->channel] = f->unit;
+            defs.eqns[f->channel] = f->eqns;
+        }
+    }
+    for (uint8_t b = 0; b < APRS_TLM_DIGITAL; b++) {
+        defs.name[APRS_TLM_ANALOG + b] = tlm_bit_names[b];
+    }
+    defs.bits_sense = 0xFF;
+    defs.title = "OrbitRadio-5 HK";
+}
+
+int tlm_decode(const uint8_t *rec, uint16_t len)
+{
+    uint16_t need = 1;
+    for (uint8_t i = 0; i < TLM_FIELDS; i++) need += type_size[tlm_schema[i].type];
+
+    if (len != need || rec[0] != TLM_RECORD_HK) return -1;
+
+    const uint8_t *p = rec + 1;
+    for (uint8_t i = 0; i < TLM_FIELDS; i++) {
+        tlm_slot_t *s = &tlm_slots[i];
+        switch (tlm_schema[i].type) {
+        case TLM_U8:  s->u = p[0]; break;
+        case TLM_I8:  s->i = (int8_t)p[0]; break;
+        case TLM_U16: s->u = (uint16_t)(p[0] | (p[1] << 8)); break;
+        case TLM_I16: s->i = (int16_t)(p[0] | (p[1] << 8)); break;
+        case TLM_U32:
+        case TLM_I32:
+            s->u = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                   ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+            break;
+        }
+        p += type_size[tlm_schema[i].type];
+    }
+    return 0;
+}
+
+uint8_t tlm_fieldCount(void)
+{
+    return (uint8_t)TLM_FIELDS;
+}
+
+const tlm_field_t *tlm_field(uint8_t idx)
+{
+    return (idx < TLM_FIELDS) ? &tlm_schema[idx] : NULL;
+}
+
+tlm_slot_t tlm_get(uint8_t idx)
+{
+    tlm_slot_t zero = { 0 };
+    return (idx < TLM_FIELDS) ? tlm_slots[idx] : zero;
+}
+
+static int64_t raw_value(uint8_t idx)
+{
+    tlm_type_t t = tlm_schema[idx].type;
+    return (t == TLM_U8 || t == TLM_U16 || t == TLM_U32) ?
+           (int64_t)tlm_slots[idx].u : (int64_t)tlm_slots[idx].i;
+}
+
+uint16_t tlm_aprsValue(uint8_t idx)
+{
+    if (idx >= TLM_FIELDS) return 0;
+
+    const tlm_field_t *f = &tlm_schema[idx];
+    int64_t v = (raw_value(idx) - f->offset) / (f->scale ? f->scale : 1);
+    if (v < 0) v = 0;
+    if (v > APRS_TLM_B91_MAX) v = APRS_TLM_B91_MAX;
+    return (uint16_t)v;
+}
+
+int tlm_format(char *out, size_t size, uint16_t seq)
+{
+    uint16_t analog[APRS_TLM_ANALOG] = { 0 };
+    uint8_t n_analog = 0;
+    uint8_t with_digital = 0, digital = 0;
+
+    for (uint8_t i = 0; i < TLM_FIELDS; i++) {
+        int8_t ch = tlm_schema[i].channel;
+        if (ch >= 0 && ch < APRS_TLM_ANALOG) {
+            analog[ch] = tlm_aprsValue(i);
+            if (ch + 1 > n_analog) n_analog = (uint8_t)(ch + 1);
+        } else if (ch == TLM_CH_DIGITAL) {
+            digital = (uint8_t)tlm_slots[i].u;
+            with_digital = 1;
+        }
+    }
+
+    if (size < 2) return -1;
+    out[0] = '>';
+    int n = 1;
+    if (n_analog) {
+        int m = APRS_FormatCompressedTelemetry(out + 1, size - 1, seq,
+                                               analog, n_analog, with_digital, digital);
+        if (m < 0) return -1;
+        n += m;
+    }
+
+    for (uint8_t i = 0; i < TLM_FIELDS; i++) {
+        if (tlm_schema[i].channel != TLM_CH_NONE) continue;
+        /* newlib-nano has no %lld: the slot is printed by its own sign */
+        tlm_type_t t = tlm_schema[i].type;
+        if (t == TLM_U8 || t == TLM_U16 || t == TLM_U32) {
+            n += snprintf(out + n, size - (size_t)n, " %s=%lu",
+                          tlm_schema[i].name, (unsigned long)tlm_slots[i].u);
+        } else {
+            n += snprintf(out + n, size - (size_t)n, " %s=%ld",
+                          tlm_schema[i].name, (long)tlm_slots[i].i);
+        }
+        if ((size_t)n >= size) return -1;
+    }
+    return n;
+}
+
+int tlm_formatDelta(char *out, size_t size, uint16_t seq)
+{
+    if (++tlm_since_full >= TLM_REFRESH_EVERY) {
+        int n = tlm_format(out, size, seq);
+        if (n > 0) {
+            for (uint8_t i = 0; i < TLM_FIELDS; i++) tlm_sent[i] = raw_value(i);
+            tlm_since_full = 0;
+        }
+        return n;
+    }
+
+    /* tlm_sent only moves once the whole frame is formatted */
+    int64_t pending[TLM_FIELDS];
+    memcpy(pending, tlm_sent, sizeof(pending));
+
+    if (size < 5) return -1;
+    out[0] = '>';
+    out[1] = 'D';
+    APRS_Base91(&out[2], seq % (APRS_TLM_B91_MAX + 1), 2);
+    size_t n = 4;
+    uint8_t changed = 0;
+
+    for (uint8_t i = 0; i < TLM_FIELDS; i++) {
+        const tlm_field_t *f = &tlm_schema[i];
+        int64_t raw = raw_value(i);
+        int64_t diff = raw - pending[i];
+        if (diff < 0) diff = -diff;
+        if (diff <= (int64_t)f->deadband) continue;
+
+        uint8_t width = (f->channel == TLM_CH_NONE) ? 5 : 2;
+        if (n + 1 + width + 1 > size) return -1;
+
+        out[n++] = (char)('a' + i);
+        APRS_Base91(&out[n], (f->channel == TLM_CH_NONE) ? (uint32_t)(raw - f->offset) :
+                             (f->channel == TLM_CH_DIGITAL) ? tlm_slots[i].u : tlm_aprsValue(i),
+                    width);
+        n += width;
+        pending[i] = raw;
+        changed = 1;
+    }
+
+    out[n] = 0;
+    if (!changed) return 0;
+    memcpy(tlm_sent, pending, sizeof(tlm_sent));
+    return (int)n;
+}
+
+void tlm_forceRefresh(void)
+{
+    tlm_since_full = TLM_REFRESH_EVERY;
+}
+
+uint8_t tlm_isAlarm(void)
+{
+    for (uint8_t i = 0; i < TLM_FIELDS; i++) {
+        if (tlm_schema[i].channel == TLM_CH_DIGITAL && (tlm_slots[i].u & TLM_ALARM_BITS)) return 1;
+    }
+    return 0;
+}
+
+const aprs_tlm_defs_t *tlm_defs(void)
+{
+    return &defs;
+}
@@ -0,0 +1,87 @@
+/* trace.c
+ * ITM/SWO event trace with DWT cycle stamps
+ */
+
+#include "trace.h"
+#include "dwt.h"
+
+/* ITM lock access key */
+#define ITM_UNLOCK  0xC5ACCE55U
+
+uint8_t trace_on = 0;
+volatile uint32_t trace_lost = 0;
+
+static uint32_t last_sync;
+static uint8_t ticks_on = 0;
+
+/* Event ports and the sync port, tick ports only when asked for */
+static uint32_t trace_ports(void)
+{
+    uint32_t ter = (((1UL << TRACE_EVENT_COUNT) - 1U) & ~1UL) | (1UL << TRACE_PORT_SYNC);
+    if (!ticks_on) ter &= ~((1UL << TRACE_TICK_IN) | (1UL << TRACE_TICK_OUT));
+    return ter;
+}
+
+void trace_Init(uint32_t hclk_hz)
+{
+#if TRACE_ENABLE
+    GPIO_InitTypeDef g = {0};
+
+    trace_on = 0;
+    dwt_Init();
+
+    /* PB3 as TRACESWO (AF0) */
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+    g.Pin = SWO_Pin;
+    g.Mode = GPIO_MODE_AF_PP;
+    g.Pull = GPIO_NOPULL;
+    g.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    g.Alternate = GPIO_AF0_TRACE;
+    HAL_GPIO_Init(SWO_GPIO_Port, &g);
+
+    /* Asynchronous trace pin, NRZ, formatter bypassed */
+    DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+    TPI->SPPR = 2;
+    TPI->ACPR = hclk_hz / TRACE_SWO_HZ - 1U;
+    TPI->FFCR = 0x100;
+
+    /* ITM: event ports and the sync port, no hardware timestamps */
+    ITM->LAR = ITM_UNLOCK;
+    ITM->TCR = 0;
+    ITM->TPR = 0;
+    ITM->TER = trace_ports();
+    ITM->TCR = ITM_TCR_ITMENA_Msk | ITM_TCR_SYNCENA_Msk | (1UL << ITM_TCR_TraceBusID_Pos);
+
+    last_sync = DWT->CYCCNT;
+    ITM->PORT[TRACE_PORT_SYNC].u32 = last_sync;
+    trace_on = 1;
+#else
+    (void)hclk_hz;
+#endif
+}
+
+void trace_setTicks(uint8_t on)
+{
+    ticks_on = on ? 1 : 0;
+#if TRACE_ENABLE
+    if (trace_on) ITM->TER = trace_ports();
+#endif
+}
+
+uint8_t trace_getTicks(void)
+{
+    return ticks_on;
+}
+
+void trace_Poll(void)
+{
+#if TRACE_ENABLE
+    if (!trace_on) return;
+
+    uint32_t now = DWT->CYCCNT;
+    if (now - last_sync < (1UL << 23)) return;
+    if (ITM->PORT[TRACE_PORT_SYNC].u32 == 0) return;
+    ITM->PORT[TRACE_PORT_SYNC].u32 = now;
+    last_sync = now;
+#endif
+}
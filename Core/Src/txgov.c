@@ -0,0 +1,98 @@
+/* txgov.c
+ * Transmit duty-cycle and energy governor
+ *
+ * Two token buckets, both refilled continuously and charged with the real
+ * keyed time after each transmission:
+ *   duty:   refills duty_permille us per ms, holds duty x window
+ *   energy: refills energy_avg_mw uJ per ms, holds avg x window,
+ *           a transmission costs tx_power_mw uJ per keyed ms
+ * A frame may start only when both buckets cover its estimated key time.
+ */
+
+#include "txgov.h"
+#include <string.h>
+
+static txgov_cfg_t cfg;
+static txgov_state_t st;
+static uint32_t last_tick;
+
+static int64_t duty_cap(void)   { return (int64_t)cfg.duty_window_ms * cfg.duty_permille; }
+static int64_t energy_cap(void) { return (int64_t)cfg.energy_window_ms * cfg.energy_avg_mw; }
+
+static void refill(uint32_t now)
+{
+    uint32_t dt = now - last_tick;
+    last_tick = now;
+
+    st.duty_us += (int64_t)dt * cfg.duty_permille;
+    if (st.duty_us > duty_cap()) st.duty_us = duty_cap();
+
+    st.energy_uj += (int64_t)dt * cfg.energy_avg_mw;
+    if (st.energy_uj > energy_cap()) st.energy_uj = energy_cap();
+}
+
+void txgov_Init(const txgov_cfg_t *c, uint32_t now)
+{
+    cfg = *c;
+    memset(&st, 0, sizeof(st));
+    st.duty_us = duty_cap();
+    st.energy_uj = energy_cap();
+    last_tick = now;
+}
+
+uint8_t txgov_allow(uint32_t key_ms, uint32_t now)
+{
+    refill(now);
+
+    uint32_t wait = txgov_waitMs(key_ms);
+
+    /* A frame bigger than a bucket goes out once the buckets are full */
+    if (wait == 0 || (wait == UINT32_MAX &&
+                      st.duty_us >= duty_cap() && st.energy_uj >= energy_cap())) {
+        st.deferring = 0;
+        return 1;
+    }
+    if (!st.deferring) {
+        st.deferring = 1;
+        st.deferrals++;
+    }
+    return 0;
+}
+
+void txgov_charge(uint32_t key_ms, uint32_t now)
+{
+    refill(now);
+    st.duty_us -= (int64_t)key_ms * 1000;
+    st.energy_uj -= (int64_t)key_ms * cfg.tx_power_mw;
+    st.keyed_ms += key_ms;
+}
+
+uint32_t txgov_waitMs(uint32_t key_ms)
+{
+    int64_t duty_short = (int64_t)key_ms * 1000 - st.duty_us;
+    int64_t energy_short = (int64_t)key_ms * cfg.tx_power_mw - st.energy_uj;
+    int64_t wait = 0;
+
+    if (duty_short > 0) {
+        /* Never fits if the frame is longer than the whole bucket */
+        if ((int64_t)key_ms * 1000 > duty_cap() || cfg.duty_permille == 0) return UINT32_MAX;
+        int64_t w = (duty_short + cfg.duty_permille - 1) / cfg.duty_permille;
+        if (w > wait) wait = w;
+    }
+    if (energy_short > 0) {
+        if ((int64_t)key_ms * cfg.tx_power_mw > energy_cap() || cfg.energy_avg_mw == 0) return UINT32_MAX;
+        int64_t w = (energy_short + cfg.energy_avg_mw - 1) / cfg.energy_avg_mw;
+        if (w > wait) wait = w;
+    }
+    return (uint32_t)wait;
+}
+
+const txgov_state_t *txgov_state(void)
+{
+    return &st;
+}
+
+const txgov_cfg_t *txgov_cfg(void)
+{
+    return &cfg;
+}
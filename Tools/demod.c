@@ -0,0 +1,196 @@
+/* demod.c
+ * AFSK1200 demodulator + HDLC deframer for the ground decoder.
+ *
+ * Chain per variant:
+ *   [bandpass] -> mark/space quadrature correlators (one bit long)
+ *   -> slicer -> DPLL clock recovery -> NRZI decode -> HDLC deframe
+ *   -> ax25_fcs() check
+ */
+
+#include "demod.h"
+#include "ax25.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MARK_HZ   1200.0f
+#define SPACE_HZ  2200.0f
+#define BAUD      1200.0f
+
+/* DPLL: 32-bit phase counter wraps once per bit; on every data transition
+ * the phase is pulled towards zero (mid-bit sampling point at the wrap).
+ */
+#define PLL_INERTIA 0.74f
+
+typedef struct {
+    /* HDLC */
+    uint8_t  pattern;       /* last 8 bits, newest in bit 7 */
+    uint8_t  acc;
+    uint8_t  acc_bits;
+    uint8_t  frame[DEMOD_MAX_FRAME];
+    uint16_t frame_len;
+    uint8_t  in_frame;
+    uint8_t  last_raw;      /* NRZI reference */
+} hdlc_t;
+
+/* Windowed-sinc bandpass, odd length */
+static float *make_bandpass(uint32_t fs, float lo, float hi, int taps)
+{
+    float *h = malloc(sizeof(float) * (size_t)taps);
+    if (!h) return NULL;
+
+    int mid = taps / 2;
+    for (int i = 0; i < taps; i++) {
+        int k = i - mid;
+        float wl = 2.0f * (float)M_PI * lo / (float)fs;
+        float wh = 2.0f * (float)M_PI * hi / (float)fs;
+        float v = (k == 0) ? (wh - wl) / (float)M_PI
+                           : (sinf(wh * (float)k) - sinf(wl * (float)k)) / ((float)M_PI * (float)k);
+        float win = 0.54f - 0.46f * cosf(2.0f * (float)M_PI * (float)i / (float)(taps - 1));
+        h[i] = v * win;
+    }
+    return h;
+}
+
+static unsigned hdlc_bit(hdlc_t *h, uint8_t dbit, size_t sample,
+                         demod_frame_cb cb, void *ctx)
+{
+    unsigned found = 0;
+
+    h->pattern = (uint8_t)((h->pattern >> 1) | (dbit << 7));
+
+    if (h->pattern == AX25_FLAG) {
+        /* The 7 leading bits of the flag are sitting in acc */
+        if (h->in_frame && h->acc_bits == 7 && h->frame_len >= AX25_MIN_FRAME_LEN) {
+            uint16_t body = h->frame_len - AX25_FCS_LEN;
+            uint16_t fcs = (uint16_t)(h->frame[body] | (h->frame[body + 1] << 8));
+            if (ax25_fcs(h->frame, body) == fcs) {
+                cb(ctx, h->frame, h->frame_len, sample);
+                found = 1;
+            }
+        }
+        h->in_frame = 1;
+        h->frame_len = 0;
+        h->acc = 0;
+        h->acc_bits = 0;
+        return found;
+    }
+
+    if (h->pattern == 0xFE) {
+        /* Seven ones: abort / idle */
+        h->in_frame = 0;
+        return 0;
+    }
+
+    if ((h->pattern & 0xFC) == 0x7C) {
+        /* Zero after five ones: stuffed bit */
+        return 0;
+    }
+
+    if (!h->in_frame) return 0;
+
+    h->acc = (uint8_t)((h->acc >> 1) | (dbit << 7));
+    if (++h->acc_bits == 8) {
+        if (h->frame_len < DEMOD_MAX_FRAME) {
+            h->frame[h->frame_len++] = h->acc;
+        } else {
+            h->in_frame = 0;
+        }
+        h->acc = 0;
+        h->acc_bits = 0;
+    }
+    return 0;
+}
+
+unsigned demod_run(const demod_variant_t *v, const float *x, size_t n,
+                   uint32_t sample_rate, demod_frame_cb cb, void *ctx)
+{
+    int win = (int)lrintf((float)sample_rate / BAUD);
+    if (win < 4) return 0;
+
+    int taps = 0;
+    float *bp = NULL;
+    float *hist = NULL;
+    if (v->prefilter) {
+        taps = (int)(sample_rate / 300u) | 1;
+        bp = make_bandpass(sample_rate, 900.0f, 2500.0f, taps);
+        hist = calloc((size_t)taps, sizeof(float));
+    }
+
+    /* Ring of per-sample correlator products, summed over one bit */
+    float *ring = calloc((size_t)win * 4u, sizeof(float));
+    float sum[4] = { 0 };
+    int rpos = 0, hpos = 0;
+
+    hdlc_t h;
+    memset(&h, 0, sizeof(h));
+
+    uint32_t pll = 0;
+    uint32_t pll_step = (uint32_t)llround(4294967296.0 * BAUD / (double)sample_rate);
+    uint8_t prev_bit = 0;
+    unsigned found = 0;
+
+    float wm = 2.0f * (float)M_PI * MARK_HZ / (float)sample_rate;
+    float ws = 2.0f * (float)M_PI * SPACE_HZ / (float)sample_rate;
+    float phm = 0.0f, phs = 0.0f;
+
+    for (size_t i = 0; i < n && ring; i++) {
+        float s = x[i];
+
+        if (bp && hist) {
+            hist[hpos] = s;
+            float acc = 0.0f;
+            int k = hpos;
+            for (int t = 0; t < taps; t++) {
+                acc += bp[t] * hist[k];
+                if (--k < 0) k = taps - 1;
+            }
+            if (++hpos == taps) hpos = 0;
+            s = acc;
+        }
+
+        float p[4] = {
+            s * cosf(phm), s * sinf(phm),
+            s * cosf(phs), s * sinf(phs),
+        };
+        phm += wm;
+        if (phm > 2.0f * (float)M_PI) phm -= 2.0f * (float)M_PI;
+        phs += ws;
+        if (phs > 2.0f * (float)M_PI) phs -= 2.0f * (float)M_PI;
+        for (int c = 0; c < 4; c++) {
+            sum[c] += p[c] - ring[rpos * 4 + c];
+            ring[rpos * 4 + c] = p[c];
+        }
+        if (++rpos == win) {
+            /* Re-sum once per bit so float rounding cannot accumulate */
+            rpos = 0;
+            for (int c = 0; c < 4; c++) {
+                sum[c] = 0.0f;
+                for (int k = 0; k < win; k++) sum[c] += ring[k * 4 + c];
+            }
+        }
+
+        float mark = sqrtf(sum[0] * sum[0] + sum[1] * sum[1]);
+        float space = sqrtf(sum[2] * sum[2] + sum[3] * sum[3]);
+        uint8_t bit = (mark > space * v->space_gain) ? 1 : 0;
+
+        /* Clock recovery */
+        int32_t before = (int32_t)pll;
+        pll += pll_step;
+        if (before > 0 && (int32_t)pll < 0) {
+            uint8_t dbit = (bit == h.last_raw) ? 1 : 0;  /* NRZI */
+            h.last_raw = bit;
+            found += hdlc_bit(&h, dbit, i, cb, ctx);
+        }
+        if (bit != prev_bit) {
+            pll = (uint32_t)(int32_t)((float)(int32_t)pll * PLL_INERTIA);
+        }
+        prev_bit = bit;
+    }
+
+    free(ring);
+    free(hist);
+    free(bp);
+    return found;
+}
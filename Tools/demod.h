@@ -0,0 +1,31 @@
+/* demod.h
+ * AFSK1200 demodulator + HDLC deframer for the ground decoder.
+ * Several instances with different prefilters and slicer gains run in
+ * parallel over the same recording, like a multi-decoder TNC.
+ */
+
+#ifndef DEMOD_H
+#define DEMOD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DEMOD_MAX_FRAME  512
+
+/* One demodulator variant */
+typedef struct {
+    const char *name;
+    uint8_t     prefilter;    /* 1 = 900-2500 Hz bandpass ahead of the correlators */
+    float       space_gain;   /* slicer: mark vs. space*gain (de-emphasis twist) */
+} demod_variant_t;
+
+/* Called for every frame that passes the FCS check.
+ * sample is the position of the closing flag in the recording.
+ */
+typedef void (*demod_frame_cb)(void *ctx, const uint8_t *frame, uint16_t len, size_t sample);
+
+/* Run one variant over a whole recording. Returns number of frames found. */
+unsigned demod_run(const demod_variant_t *v, const float *x, size_t n,
+                   uint32_t sample_rate, demod_frame_cb cb, void *ctx);
+
+#endif /* DEMOD_H */
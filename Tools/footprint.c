@@ -0,0 +1,443 @@
+/* footprint.c
+ * Per-function flash, RAM and stack usage of a firmware build, from the
+ * linker map (RX_Final.map) and the compiler's -fstack-usage files.
+ *
+ * Every input section of the memory map is one entry, named after its
+ * -ffunction-sections / -fdata-sections suffix (".text.afsk_Init" ->
+ * afsk_Init). Sections without a suffix (.RamFunc, COMMON) are split at
+ * the global symbols listed under them; static functions in .RamFunc are
+ * counted with the symbol before them. Initialised data and .RamFunc
+ * count toward both flash (load image) and RAM. In an LTO build the
+ * stack figures come from the fat objects (-ffat-lto-objects), i.e. the
+ * frames before cross-file inlining.
+ *
+ * With a second map, prints the per-function change from the first one
+ * instead, so a change can be judged by its footprint delta.
+ *
+ * usage: footprint [-n count] [-s su_dir] RX_Final.map
+ *        footprint [-n count] base.map new.map
+ *   -n  list only the largest entries (default: all)
+ *   -s  where to look for *.su files (default: the map's directory)
+ */
+
+#define _XOPEN_SOURCE 700
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* STM32F446RE */
+#define FLASH_BASE_ADDR  0x08000000UL
+#define FLASH_END_ADDR   0x08080000UL
+#define SRAM_BASE_ADDR   0x20000000UL
+#define SRAM_END_ADDR    0x20020000UL
+
+#define NAME_MAX_LEN     96
+#define LINE_MAX_LEN     1024
+
+typedef struct {
+    char name[NAME_MAX_LEN];
+    char object[NAME_MAX_LEN];
+    unsigned long flash, ram;
+    long stack;                 /* -1 = no .su entry */
+    int seen;                   /* diff mode: 1 base, 2 new, 3 both */
+    unsigned long base_flash, base_ram;
+} entry_t;
+
+typedef struct {
+    entry_t *v;
+    size_t n, cap;
+} table_t;
+
+static table_t syms;
+
+/* Stack usage from the .su files: function, source base name, bytes */
+typedef struct {
+    char func[NAME_MAX_LEN];
+    char src[NAME_MAX_LEN];
+    long bytes;
+} su_t;
+
+static su_t *su;
+static size_t su_n, su_cap;
+
+static const char *base_name(const char *path)
+{
+    const char *s = strrchr(path, '/');
+    const char *b = strrchr(path, '\\');
+    if (b && (!s || b > s)) s = b;
+    return s ? s + 1 : path;
+}
+
+/* LTO partitions are temporary files with a new name every build */
+static const char *object_name(const char *path)
+{
+    return strstr(path, ".ltrans") ? "(lto)" : base_name(path);
+}
+
+static int in_flash(unsigned long a) { return a >= FLASH_BASE_ADDR && a < FLASH_END_ADDR; }
+static int in_sram(unsigned long a)  { return a >= SRAM_BASE_ADDR && a < SRAM_END_ADDR; }
+
+static entry_t *entry_get(table_t *t, const char *name, const char *object)
+{
+    for (size_t i = 0; i < t->n; i++) {
+        if (strcmp(t->v[i].name, name) == 0 && strcmp(t->v[i].object, object) == 0) return &t->v[i];
+    }
+    if (t->n == t->cap) {
+        t->cap = t->cap ? 2 * t->cap : 256;
+        t->v = realloc(t->v, t->cap * sizeof(*t->v));
+        if (!t->v) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    entry_t *e = &t->v[t->n++];
+    memset(e, 0, sizeof(*e));
+    snprintf(e->name, sizeof(e->name), "%s", name);
+    snprintf(e->object, sizeof(e->object), "%s", object);
+    e->stack = -1;
+    return e;
+}
+
+/* One piece of an input section: [addr, addr + size) */
+static void account(table_t *t, const char *name, const char *object,
+                    unsigned long addr, unsigned long size, int loaded)
+{
+    if (size == 0) return;
+    if (!in_flash(addr) && !in_sram(addr)) return;
+
+    entry_t *e = entry_get(t, name, object);
+    if (in_flash(addr) || loaded) e->flash += size;
+    if (in_sram(addr)) e->ram += size;
+}
+
+/* Input section being collected, with the global symbols listed under it */
+#define SEC_SYMS_MAX  64
+
+typedef struct {
+    char name[NAME_MAX_LEN];
+    char object[NAME_MAX_LEN];
+    unsigned long addr, size;
+    int loaded;
+    int nsyms;
+    unsigned long sym_addr[SEC_SYMS_MAX];
+    char sym_name[SEC_SYMS_MAX][NAME_MAX_LEN];
+} section_t;
+
+static void section_flush(table_t *t, section_t *s)
+{
+    if (s->name[0] == 0) return;
+
+    /* The map gives .bss a load address too, but nothing is stored there */
+    if (strncmp(s->name, ".bss", 4) == 0 || strcmp(s->name, "COMMON") == 0) s->loaded = 0;
+
+    /* ".text.foo" -> "foo"; output-section names keep their dot */
+    const char *suffix = strchr(s->name + 1, '.');
+    if (suffix && s->name[0] == '.') {
+        account(t, suffix + 1, s->object, s->addr, s->size, s->loaded);
+    } else {
+        unsigned long at = s->addr, end = s->addr + s->size;
+        char anon[NAME_MAX_LEN + 2];
+
+        snprintf(anon, sizeof(anon), "(%s)", s->name);
+        for (int i = 0; i <= s->nsyms; i++) {
+            unsigned long next = (i < s->nsyms) ? s->sym_addr[i] : end;
+            if (next > end) next = end;
+            if (next > at) account(t, i ? s->sym_name[i - 1] : anon, s->object, at, next - at, s->loaded);
+            if (next > at) at = next;
+        }
+    }
+    s->name[0] = 0;
+}
+
+static int is_hex(const char *p)
+{
+    return p[0] == '0' && p[1] == 'x';
+}
+
+static void load_map(table_t *t, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[LINE_MAX_LEN];
+    int in_map = 0, loaded = 0;
+    section_t sec = { 0 };
+    char pending[NAME_MAX_LEN] = "";
+
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = 0;
+        if (!in_map) {
+            in_map = (strncmp(line, "Linker script and memory map", 28) == 0);
+            continue;
+        }
+
+        /* Output section: ".data  0x20000000  0x10c load address 0x08006000" */
+        if (line[0] == '.') {
+            section_flush(t, &sec);
+            unsigned long vma = 0;
+            char *p = strstr(line, "0x");
+            if (p) vma = strtoul(p, NULL, 16);
+            p = strstr(line, "load address");
+            loaded = 0;
+            if (p) {
+                unsigned long lma = strtoul(strstr(p, "0x"), NULL, 16);
+                loaded = (lma != vma && in_flash(lma));
+            }
+            pending[0] = 0;
+            continue;
+        }
+        if (line[0] != ' ') {
+            section_flush(t, &sec);
+            pending[0] = 0;
+            continue;
+        }
+
+        char *p = line;
+        while (*p == ' ') p++;
+        if (*p == 0 || *p == '*') {
+            if (strncmp(p, "*fill*", 6) != 0) section_flush(t, &sec);
+            continue;
+        }
+
+        if (is_hex(p)) {
+            char a[32], b[NAME_MAX_LEN], c[LINE_MAX_LEN];
+            int n = sscanf(p, "%31s %95s %1023s", a, b, c);
+
+            if (pending[0] && n == 3 && is_hex(b)) {
+                /* Continuation of a long input section name */
+                section_flush(t, &sec);
+                snprintf(sec.name, sizeof(sec.name), "%s", pending);
+                snprintf(sec.object, sizeof(sec.object), "%s", object_name(c));
+                sec.addr = strtoul(a, NULL, 16);
+                sec.size = strtoul(b, NULL, 16);
+                sec.loaded = loaded;
+                sec.nsyms = 0;
+            } else if (n == 2 && sec.name[0] && !is_hex(b) && strchr(b, '=') == NULL &&
+                       strcmp(b, "PROVIDE") != 0 && sec.nsyms < SEC_SYMS_MAX) {
+                /* Symbol: "0x08000244   afsk_Init" */
+                sec.sym_addr[sec.nsyms] = strtoul(a, NULL, 16);
+                snprintf(sec.sym_name[sec.nsyms], NAME_MAX_LEN, "%s", b);
+                sec.nsyms++;
+            }
+            pending[0] = 0;
+            continue;
+        }
+
+        /* Input section: " .text.foo  0xADDR  0xSIZE  object", or the name
+         * alone when it is too long, with the rest on the next line
+         */
+        if (*p == '.' || strncmp(p, "COMMON", 6) == 0) {
+            char name[NAME_MAX_LEN], a[32], b[32], c[LINE_MAX_LEN];
+            int n = sscanf(p, "%95s %31s %31s %1023s", name, a, b, c);
+
+            section_flush(t, &sec);
+            pending[0] = 0;
+            if (n == 1) {
+                snprintf(pending, sizeof(pending), "%s", name);
+            } else if (n == 4 && is_hex(a) && is_hex(b)) {
+                snprintf(sec.name, sizeof(sec.name), "%s", name);
+                snprintf(sec.object, sizeof(sec.object), "%s", object_name(c));
+                sec.addr = strtoul(a, NULL, 16);
+                sec.size = strtoul(b, NULL, 16);
+                sec.loaded = loaded;
+                sec.nsyms = 0;
+            }
+            continue;
+        }
+        section_flush(t, &sec);
+    }
+    section_flush(t, &sec);
+    fclose(f);
+
+    if (!in_map) {
+        fprintf(stderr, "%s: no memory map found\n", path);
+        exit(1);
+    }
+}
+
+/* "afsk.c:493:6:afsk_timer_tick\t16\tstatic" */
+static int su_file(const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+    (void)st;
+    (void)ftw;
+    size_t len = strlen(path);
+    if (type != FTW_F || len < 3 || strcmp(path + len - 3, ".su") != 0) return 0;
+
+    FILE *f = fopen(path, "r");
+    char line[LINE_MAX_LEN];
+    if (!f) return 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        char *tab = strchr(line, '\t');
+        if (!tab) continue;
+        *tab = 0;
+
+        char *func = strrchr(line, ':');
+        char *colon = strchr(line, ':');
+        if (!func || !colon) continue;
+        *colon = 0;
+
+        if (su_n == su_cap) {
+            su_cap = su_cap ? 2 * su_cap : 256;
+            su = realloc(su, su_cap * sizeof(*su));
+            if (!su) {
+                perror("realloc");
+                exit(1);
+            }
+        }
+        snprintf(su[su_n].func, NAME_MAX_LEN, "%s", func + 1);
+        snprintf(su[su_n].src, NAME_MAX_LEN, "%s", base_name(line));
+        su[su_n].bytes = strtol(tab + 1, NULL, 10);
+        su_n++;
+    }
+    fclose(f);
+    return 0;
+}
+
+/* Stack of a function: the .su entry from the same source if there is one,
+ * otherwise the largest entry of that name (LTO objects have no source)
+ */
+static long stack_of(const entry_t *e)
+{
+    char src[NAME_MAX_LEN];
+    long any = -1;
+
+    snprintf(src, sizeof(src), "%s", e->object);
+    char *dot = strrchr(src, '.');
+    if (dot && strcmp(dot, ".o") == 0) strcpy(dot, ".c");
+
+    for (size_t i = 0; i < su_n; i++) {
+        if (strcmp(su[i].func, e->name) != 0) continue;
+        if (strcmp(su[i].src, src) == 0) return su[i].bytes;
+        if (su[i].bytes > any) any = su[i].bytes;
+    }
+    return any;
+}
+
+static int by_size(const void *a, const void *b)
+{
+    const entry_t *x = a, *y = b;
+    unsigned long sx = x->flash + x->ram, sy = y->flash + y->ram;
+    if (sx != sy) return sx < sy ? 1 : -1;
+    return strcmp(x->name, y->name);
+}
+
+static long delta(const entry_t *e)
+{
+    return (long)(e->flash + e->ram) - (long)(e->base_flash + e->base_ram);
+}
+
+static int by_delta(const void *a, const void *b)
+{
+    long dx = labs(delta(a)), dy = labs(delta(b));
+    if (dx != dy) return dx < dy ? 1 : -1;
+    return strcmp(((const entry_t *)a)->name, ((const entry_t *)b)->name);
+}
+
+static void report(size_t limit)
+{
+    unsigned long flash = 0, ram = 0;
+    long stack_max = 0;
+    const char *stack_fn = "-";
+
+    qsort(syms.v, syms.n, sizeof(*syms.v), by_size);
+    printf("%8s %8s %6s  %-40s %s\n", "flash", "ram", "stack", "name", "object");
+    for (size_t i = 0; i < syms.n; i++) {
+        entry_t *e = &syms.v[i];
+        e->stack = stack_of(e);
+        flash += e->flash;
+        ram += e->ram;
+        if (e->stack > stack_max) {
+            stack_max = e->stack;
+            stack_fn = e->name;
+        }
+        if (limit && i >= limit) continue;
+        if (e->stack >= 0) {
+            printf("%8lu %8lu %6ld  %-40s %s\n", e->flash, e->ram, e->stack, e->name, e->object);
+        } else {
+            printf("%8lu %8lu %6s  %-40s %s\n", e->flash, e->ram, "-", e->name, e->object);
+        }
+    }
+    printf("# total: flash %lu bytes, ram %lu bytes (static), %zu entries\n", flash, ram, syms.n);
+    if (su_n) printf("# largest frame: %ld bytes (%s), from %zu .su entries\n", stack_max, stack_fn, su_n);
+    else printf("# no .su files found: build with -fstack-usage\n");
+}
+
+static void report_diff(size_t limit)
+{
+    long dflash = 0, dram = 0;
+    size_t shown = 0;
+
+    qsort(syms.v, syms.n, sizeof(*syms.v), by_delta);
+    printf("%8s %8s %8s %8s  %-40s %s\n", "flash", "d_flash", "ram", "d_ram", "name", "object");
+    for (size_t i = 0; i < syms.n; i++) {
+        const entry_t *e = &syms.v[i];
+        long df = (long)e->flash - (long)e->base_flash;
+        long dr = (long)e->ram - (long)e->base_ram;
+        dflash += df;
+        dram += dr;
+        if (df == 0 && dr == 0) continue;
+        if (limit && shown >= limit) continue;
+        shown++;
+        printf("%8lu %+8ld %8lu %+8ld  %-40s %s%s\n", e->flash, df, e->ram, dr, e->name, e->object,
+               e->seen == 1 ? "  (removed)" : e->seen == 2 ? "  (new)" : "");
+    }
+    printf("# total: flash %+ld bytes, ram %+ld bytes\n", dflash, dram);
+}
+
+int main(int argc, char **argv)
+{
+    size_t limit = 0;
+    const char *su_dir = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+        case 'n': limit = strtoul(optarg, NULL, 10); break;
+        case 's': su_dir = optarg; break;
+        default:
+            goto usage;
+        }
+    }
+    if (argc - optind == 1) {
+        char dir[LINE_MAX_LEN];
+        if (!su_dir) {
+            snprintf(dir, sizeof(dir), "%s", argv[optind]);
+            char *s = strrchr(dir, '/');
+            if (s) *s = 0;
+            else strcpy(dir, ".");
+            su_dir = dir;
+        }
+        load_map(&syms, argv[optind]);
+        nftw(su_dir, su_file, 16, FTW_PHYS);
+        report(limit);
+        return 0;
+    }
+    if (argc - optind == 2) {
+        table_t base = { 0 };
+
+        load_map(&base, argv[optind]);
+        load_map(&syms, argv[optind + 1]);
+        for (size_t i = 0; i < syms.n; i++) syms.v[i].seen = 2;
+        for (size_t i = 0; i < base.n; i++) {
+            entry_t *e = entry_get(&syms, base.v[i].name, base.v[i].object);
+            e->base_flash = base.v[i].flash;
+            e->base_ram = base.v[i].ram;
+            e->seen |= 1;
+        }
+        free(base.v);
+        report_diff(limit);
+        return 0;
+    }
+
+usage:
+    fprintf(stderr, "usage: %s [-n count] [-s su_dir] RX_Final.map\n"
+                    "       %s [-n count] base.map new.map\n", argv[0], argv[0]);
+    return 2;
+}
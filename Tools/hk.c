@@ -0,0 +1,155 @@
+/* hk.c
+ * Rebuilds OBC housekeeping from full and ">D" delta telemetry frames.
+ */
+
+#include "hk.h"
+#include "tlm.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Base91 digits as written by APRS_Base91(); -1 on a bad digit */
+static int64_t base91(const uint8_t *p, unsigned width)
+{
+    int64_t v = 0;
+
+    for (unsigned i = 0; i < width; i++) {
+        if (p[i] < 33 || p[i] > 33 + 90) return -1;
+        v = v * 91 + (p[i] - 33);
+    }
+    return v;
+}
+
+static int is_delta(const ax25_frame_t *f)
+{
+    return f->info_len >= 4 && f->info[0] == '>' && f->info[1] == 'D';
+}
+
+static int is_full(const ax25_frame_t *f)
+{
+    return f->info_len >= 2 && f->info[0] == '>' && f->info[1] == '|';
+}
+
+int hk_is_frame(const ax25_frame_t *f)
+{
+    if (f->control != AX25_CTRL_UI || f->pid != AX25_PID_NO_L3) return 0;
+    return is_full(f) || is_delta(f);
+}
+
+/* ">|" ss aa.. [dd] "|" { " " name "=" value } */
+static int apply_full(hk_state_t *s, const ax25_frame_t *f)
+{
+    uint8_t count = tlm_fieldCount();
+    uint8_t n_analog = 0, with_digital = 0;
+    int64_t value[HK_MAX_FIELDS] = { 0 };
+    char text[256];
+
+    for (uint8_t i = 0; i < count; i++) {
+        int8_t ch = tlm_field(i)->channel;
+        if (ch >= 0 && ch < APRS_TLM_ANALOG && ch + 1 > n_analog) n_analog = (uint8_t)(ch + 1);
+        if (ch == TLM_CH_DIGITAL) with_digital = 1;
+    }
+
+    size_t end = 2 + 2 + 2 * (size_t)n_analog + (with_digital ? 2 : 0);
+    if (f->info_len < end + 1 || f->info[end] != '|') return -1;
+
+    int64_t seq = base91(f->info + 2, 2);
+    if (seq < 0) return -1;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const tlm_field_t *fd = tlm_field(i);
+        if (fd->channel >= 0 && fd->channel < APRS_TLM_ANALOG) {
+            value[i] = base91(f->info + 4 + 2 * fd->channel, 2);
+        } else if (fd->channel == TLM_CH_DIGITAL) {
+            value[i] = base91(f->info + 4 + 2 * n_analog, 2);
+        } else {
+            continue;
+        }
+        if (value[i] < 0) return -1;
+    }
+
+    /* Text fields follow as " name=value" */
+    size_t n = f->info_len - end - 1;
+    if (n >= sizeof(text)) return -1;
+    memcpy(text, f->info + end + 1, n);
+    text[n] = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const tlm_field_t *fd = tlm_field(i);
+        char key[40];
+        char *at, *stop;
+
+        if (fd->channel != TLM_CH_NONE) continue;
+        snprintf(key, sizeof(key), " %s=", fd->name);
+        if (!(at = strstr(text, key))) return -1;
+        value[i] = strtoll(at + strlen(key), &stop, 10);
+        if (stop == at + strlen(key)) return -1;
+    }
+
+    memcpy(s->value, value, sizeof(s->value));
+    s->seq = (uint16_t)seq;
+    s->valid = 1;
+    s->stale = 0;
+    return 0;
+}
+
+/* ">D" ss { k vv | k vvvvv } */
+static int apply_delta(hk_state_t *s, const ax25_frame_t *f)
+{
+    uint8_t count = tlm_fieldCount();
+    int64_t value[HK_MAX_FIELDS];
+    size_t p = 4;
+
+    if (!s->valid) return -1;
+
+    int64_t seq = base91(f->info + 2, 2);
+    if (seq < 0) return -1;
+
+    memcpy(value, s->value, sizeof(value));
+    while (p < f->info_len) {
+        unsigned i = (unsigned)(f->info[p] - 'a');
+        if (f->info[p] < 'a' || i >= count) return -1;
+
+        const tlm_field_t *fd = tlm_field((uint8_t)i);
+        unsigned width = (fd->channel == TLM_CH_NONE) ? 5 : 2;
+        if (p + 1 + width > f->info_len) return -1;
+
+        int64_t v = base91(f->info + p + 1, width);
+        if (v < 0) return -1;
+        value[i] = (fd->channel == TLM_CH_NONE) ? v + fd->offset : v;
+        p += 1 + width;
+    }
+
+    if (seq != (s->seq + 1) % (APRS_TLM_B91_MAX + 1)) s->stale = 1;
+    memcpy(s->value, value, sizeof(s->value));
+    s->seq = (uint16_t)seq;
+    return 0;
+}
+
+int hk_apply(hk_state_t *s, const ax25_frame_t *f)
+{
+    if (tlm_fieldCount() > HK_MAX_FIELDS || !hk_is_frame(f)) return -1;
+    return is_delta(f) ? apply_delta(s, f) : apply_full(s, f);
+}
+
+void hk_print_csv(const hk_state_t *s, double time_s, const ax25_frame_t *f, FILE *out)
+{
+    fprintf(out, "%.3f,%s-%u,\"hk %u%s\"", time_s, f->src, f->src_ssid,
+            s->seq, s->stale ? " stale" : "");
+
+    for (uint8_t i = 0; i < tlm_fieldCount(); i++) {
+        const tlm_field_t *fd = tlm_field(i);
+        double a = 0, b = 1, c = 0;
+
+        fputc(i ? ';' : ',', out);
+        if (fd->channel == TLM_CH_DIGITAL) {
+            fprintf(out, "%s=0x%02x", fd->name, (unsigned)s->value[i]);
+        } else if (fd->channel == TLM_CH_NONE) {
+            fprintf(out, "%s=%lld", fd->name, (long long)s->value[i]);
+        } else {
+            double x = (double)s->value[i];
+            if (fd->eqns) sscanf(fd->eqns, "%lf,%lf,%lf", &a, &b, &c);
+            fprintf(out, "%s=%g", fd->name, a * x * x + b * x + c);
+        }
+    }
+    fputc('\n', out);
+}
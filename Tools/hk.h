@@ -0,0 +1,39 @@
+/* hk.h
+ * Rebuilds OBC housekeeping from OrbitRadio telemetry frames: full frames
+ * (tlm_format()) and the ">D" delta frames between them (tlm_formatDelta()).
+ * The field layout comes from the firmware schema (Core/Src/tlm.c).
+ */
+
+#ifndef HK_H
+#define HK_H
+
+#include "ax25.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#define HK_MAX_FIELDS  32
+
+typedef struct {
+    int      valid;                 /* a full frame has been applied */
+    int      stale;                 /* a delta went missing since then */
+    uint16_t seq;                   /* of the last frame applied */
+    int64_t  value[HK_MAX_FIELDS];  /* APRS value (channel fields), bits
+                                     * (digital) or raw value (text fields) */
+} hk_state_t;
+
+/* Frame is a full or delta housekeeping frame */
+int hk_is_frame(const ax25_frame_t *f);
+
+/* Apply a frame to the state. Returns 0, or -1 if it is not a housekeeping
+ * frame or is malformed, or is a delta with no full frame before it (state
+ * unchanged). A sequence gap before a delta marks the state stale until the
+ * next full frame.
+ */
+int hk_apply(hk_state_t *s, const ax25_frame_t *f);
+
+/* One CSV line: time,source,"hk <seq>[ stale]",name=value;...
+ * Analog channels are converted with their EQNS.
+ */
+void hk_print_csv(const hk_state_t *s, double time_s, const ax25_frame_t *f, FILE *out);
+
+#endif /* HK_H */
@@ -0,0 +1,76 @@
+/* log_decode.c
+ * Expands the binary debug log (Core/Src/log.c) to text lines.
+ *
+ * Reads a capture of the USART2 output (file or stdin, e.g. a serial
+ * port) and prints one "[seconds] text" line per record. Garbage between
+ * records is skipped: a record is accepted when its id is known and the
+ * next sync byte (or the end of input) follows it.
+ *
+ * usage: log_decode [capture.bin]
+ */
+
+#include "log_fmt.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BUF_SIZE  (2 * (LOG_HDR_LEN + LOG_ARGS_MAX))
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *in = stdin;
+    static uint8_t buf[BUF_SIZE];
+    size_t have = 0;
+    unsigned long skipped = 0;
+    int eof = 0;
+
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [capture.bin]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2 && !(in = fopen(argv[1], "rb"))) {
+        perror(argv[1]);
+        return 1;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    for (;;) {
+        /* Byte at a time, so a live serial port is decoded as it arrives */
+        if (!eof && have < sizeof(buf)) {
+            int c = getc(in);
+            if (c == EOF) eof = 1;
+            else buf[have++] = (uint8_t)c;
+        }
+        if (have == 0) break;
+
+        size_t drop = 1;
+        if (buf[0] == LOG_SYNC && have >= LOG_HDR_LEN) {
+            size_t len = LOG_HDR_LEN + buf[2];
+            if (have < len + 1 && !eof) continue;     /* wait for the rest */
+            if (buf[1] < LOG_COUNT && have >= len && (have == len || buf[len] == LOG_SYNC)) {
+                char text[LOG_STR_MAX + 256];
+                if (log_fmt_expand(text, sizeof(text), buf[1], &buf[LOG_HDR_LEN], buf[2]) >= 0) {
+                    if (skipped) printf("# skipped %lu bytes\n", skipped);
+                    skipped = 0;
+                    printf("[%10.3f] %s\n", get_u32(&buf[3]) / 1000.0, text);
+                    drop = len;
+                }
+            }
+        } else if (buf[0] == LOG_SYNC && !eof) {
+            continue;
+        }
+
+        if (drop == 1) skipped++;
+        memmove(buf, buf + drop, have - drop);
+        have -= drop;
+    }
+
+    if (skipped) printf("# skipped %lu bytes\n", skipped);
+    if (in != stdin) fclose(in);
+    return 0;
+}
@@ -0,0 +1,239 @@
+/* orbit_decode.c
+ * Ground-side OrbitRadio pass decoder.
+ *
+ * Runs every demodulator variant over every recording on a pool of worker
+ * threads, merges the frames the variants agree on, reassembles fragmented
+ * status records, rebuilds housekeeping from full and ">D" delta frames,
+ * and prints them as TNC2 monitor lines or (with -t) as telemetry CSV
+ * records.
+ *
+ * usage: orbit_decode [-j threads] [-t] pass1.wav [pass2.wav ...]
+ */
+
+#include "ax25.h"
+#include "demod.h"
+#include "hk.h"
+#include "reasm.h"
+#include "telemetry.h"
+#include "wav.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Multi-decoder set: with and without prefilter, several slicer gains to
+ * cover the mark/space twist that pre/de-emphasis leaves on FM receivers.
+ */
+static const demod_variant_t variants[] = {
+    { "flat/0.50", 0, 0.50f }, { "flat/0.71", 0, 0.71f }, { "flat/1.00", 0, 1.00f },
+    { "flat/1.41", 0, 1.41f }, { "flat/2.00", 0, 2.00f },
+    { "bpf/0.50",  1, 0.50f }, { "bpf/0.71",  1, 0.71f }, { "bpf/1.00",  1, 1.00f },
+    { "bpf/1.41",  1, 1.41f }, { "bpf/2.00",  1, 2.00f },
+};
+#define NUM_VARIANTS (sizeof(variants) / sizeof(variants[0]))
+
+/* Same frame seen by two variants within this many bit times is one frame */
+#define MERGE_WINDOW_BITS 16
+
+typedef struct {
+    size_t   sample;
+    uint16_t len;
+    uint8_t  data[DEMOD_MAX_FRAME];
+    uint32_t variant_mask;
+} hit_t;
+
+typedef struct {
+    hit_t *hits;
+    size_t count, cap;
+} hit_list_t;
+
+typedef struct {
+    const wav_t *wav;
+    unsigned     variant;
+    hit_list_t   out;
+} job_t;
+
+static job_t *jobs;
+static size_t job_count;
+static atomic_size_t next_job;
+
+static void collect(void *ctx, const uint8_t *frame, uint16_t len, size_t sample)
+{
+    job_t *j = ctx;
+    hit_list_t *l = &j->out;
+
+    if (l->count == l->cap) {
+        size_t cap = l->cap ? l->cap * 2 : 64;
+        hit_t *n = realloc(l->hits, cap * sizeof(hit_t));
+        if (!n) return;
+        l->hits = n;
+        l->cap = cap;
+    }
+    hit_t *h = &l->hits[l->count++];
+    h->sample = sample;
+    h->len = len;
+    memcpy(h->data, frame, len);
+    h->variant_mask = 1u << j->variant;
+}
+
+static void *worker(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        size_t i = atomic_fetch_add(&next_job, 1);
+        if (i >= job_count) break;
+        job_t *j = &jobs[i];
+        demod_run(&variants[j->variant], j->wav->samples, j->wav->count,
+                  j->wav->sample_rate, collect, j);
+    }
+    return NULL;
+}
+
+static int by_sample(const void *a, const void *b)
+{
+    const hit_t *x = a, *y = b;
+    return (x->sample > y->sample) - (x->sample < y->sample);
+}
+
+/* Fold the per-variant lists of one recording into a single sorted list */
+static hit_list_t merge(job_t *first, unsigned n, uint32_t sample_rate)
+{
+    hit_list_t all = { 0 };
+    size_t window = (size_t)sample_rate / 1200u * MERGE_WINDOW_BITS;
+
+    for (unsigned v = 0; v < n; v++) all.cap += first[v].out.count;
+    all.hits = malloc((all.cap ? all.cap : 1) * sizeof(hit_t));
+    if (!all.hits) return all;
+    for (unsigned v = 0; v < n; v++) {
+        memcpy(&all.hits[all.count], first[v].out.hits, first[v].out.count * sizeof(hit_t));
+        all.count += first[v].out.count;
+    }
+    qsort(all.hits, all.count, sizeof(hit_t), by_sample);
+
+    size_t w = 0;
+    for (size_t i = 0; i < all.count; i++) {
+        hit_t *h = &all.hits[i];
+        int dup = 0;
+        for (size_t k = w; k > 0 && h->sample - all.hits[k - 1].sample <= window; k--) {
+            hit_t *p = &all.hits[k - 1];
+            if (p->len == h->len && memcmp(p->data, h->data, h->len) == 0) {
+                p->variant_mask |= h->variant_mask;
+                dup = 1;
+                break;
+            }
+        }
+        if (!dup) all.hits[w++] = *h;
+    }
+    all.count = w;
+    return all;
+}
+
+static void print_tnc2(const ax25_frame_t *f, double t, unsigned votes)
+{
+    printf("[%8.3f %2u/%zu] %s-%u>%s-%u", t, votes, NUM_VARIANTS,
+           f->src, f->src_ssid, f->dst, f->dst_ssid);
+    for (unsigned i = 0; i < f->path_count; i++) {
+        printf(",%s-%u", f->path[i], f->path_ssid[i]);
+    }
+    printf(":%.*s\n", (int)f->info_len, (const char *)f->info);
+}
+
+int main(int argc, char **argv)
+{
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int csv = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "j:t")) != -1) {
+        switch (opt) {
+        case 'j': threads = strtol(optarg, NULL, 10); break;
+        case 't': csv = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-j threads] [-t] pass.wav...\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "usage: %s [-j threads] [-t] pass.wav...\n", argv[0]);
+        return 2;
+    }
+    if (threads < 1) threads = 1;
+
+    int files = argc - optind;
+    wav_t *wavs = calloc((size_t)files, sizeof(wav_t));
+    job_count = (size_t)files * NUM_VARIANTS;
+    jobs = calloc(job_count, sizeof(job_t));
+    if (!wavs || !jobs) return 1;
+
+    for (int f = 0; f < files; f++) {
+        if (wav_load(argv[optind + f], &wavs[f]) != 0) return 1;
+        for (unsigned v = 0; v < NUM_VARIANTS; v++) {
+            job_t *j = &jobs[(size_t)f * NUM_VARIANTS + v];
+            j->wav = &wavs[f];
+            j->variant = v;
+        }
+    }
+
+    pthread_t *tid = calloc((size_t)threads, sizeof(pthread_t));
+    if (!tid) return 1;
+    for (long t = 0; t < threads; t++) {
+        int rc = pthread_create(&tid[t], NULL, worker, NULL);
+        if (rc != 0) {
+            fprintf(stderr, "%s: thread %ld: %s\n", argv[0], t, strerror(rc));
+            return 1;
+        }
+    }
+    for (long t = 0; t < threads; t++) pthread_join(tid[t], NULL);
+
+    if (csv) printf("time_s,source,text,fields\n");
+
+    /* Shared by all recordings, so a record split across passes completes */
+    static reasm_t reasm;
+    static hk_state_t hk;
+    static char info[REASM_MAX_INFO];
+
+    for (int f = 0; f < files; f++) {
+        hit_list_t all = merge(&jobs[(size_t)f * NUM_VARIANTS], NUM_VARIANTS, wavs[f].sample_rate);
+
+        if (!csv) printf("# %s: %zu frames\n", argv[optind + f], all.count);
+
+        for (size_t i = 0; i < all.count; i++) {
+            ax25_frame_t fr;
+            if (ax25_decode(all.hits[i].data, all.hits[i].len, &fr) != 0) continue;
+            double t = (double)all.hits[i].sample / wavs[f].sample_rate;
+
+            if (reasm_is_fragment(&fr)) {
+                if (!csv) print_tnc2(&fr, t, (unsigned)__builtin_popcount(all.hits[i].variant_mask));
+                size_t n = reasm_add(&reasm, &fr, t, info, sizeof(info));
+                if (n == 0) continue;
+                /* Carry on with the reassembled record in place of the fragment */
+                fr.info = (const uint8_t *)info;
+                fr.info_len = (uint16_t)n;
+                if (!csv) printf("# reassembled %s record\n", fr.src);
+            }
+
+            if (csv && hk_is_frame(&fr)) {
+                /* Deltas only make sense on top of the last full frame */
+                if (hk_apply(&hk, &fr) == 0) hk_print_csv(&hk, t, &fr, stdout);
+            } else if (csv) {
+                tlm_record_t rec;
+                for (unsigned k = 0; tlm_parse(&fr, t, k, &rec) == 0; k++) {
+                    tlm_print_csv(&rec, stdout);
+                }
+            } else {
+                print_tnc2(&fr, t, (unsigned)__builtin_popcount(all.hits[i].variant_mask));
+            }
+        }
+        free(all.hits);
+    }
+
+    for (size_t i = 0; i < job_count; i++) free(jobs[i].out.hits);
+    for (int f = 0; f < files; f++) wav_free(&wavs[f]);
+    free(tid);
+    free(jobs);
+    free(wavs);
+    return 0;
+}
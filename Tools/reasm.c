@@ -0,0 +1,86 @@
+/* reasm.c
+ * Reassembles fragmented OrbitRadio status records.
+ */
+
+#include "reasm.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Must match the header written by frag_next() in Core/Src/frag.c */
+#define FRAG_PREFIX ">#F"
+
+static int parse_header(const ax25_frame_t *f, unsigned *id, unsigned *index,
+                        unsigned *count, size_t *hdr_len)
+{
+    char hdr[16];
+    size_t n = f->info_len < sizeof(hdr) - 1 ? f->info_len : sizeof(hdr) - 1;
+    int used = 0;
+
+    memcpy(hdr, f->info, n);
+    hdr[n] = 0;
+    if (sscanf(hdr, FRAG_PREFIX "%2x,%u/%u:%n", id, index, count, &used) != 3 || used == 0) return -1;
+    if (*count == 0 || *count > REASM_MAX_FRAGS || *index == 0 || *index > *count) return -1;
+    *hdr_len = (size_t)used;
+    return 0;
+}
+
+int reasm_is_fragment(const ax25_frame_t *f)
+{
+    unsigned id, index, count;
+    size_t hdr_len;
+    return parse_header(f, &id, &index, &count, &hdr_len) == 0;
+}
+
+size_t reasm_add(reasm_t *r, const ax25_frame_t *f, double time_s,
+                 char *info, size_t size)
+{
+    unsigned id, index, count;
+    size_t hdr_len;
+    char source[16];
+
+    if (parse_header(f, &id, &index, &count, &hdr_len) != 0) return 0;
+    snprintf(source, sizeof(source), "%s-%u", f->src, f->src_ssid);
+
+    reasm_slot_t *s = NULL, *oldest = &r->slot[0];
+    for (unsigned i = 0; i < REASM_SLOTS; i++) {
+        reasm_slot_t *c = &r->slot[i];
+        if (c->used && c->id == id && c->count == count && strcmp(c->source, source) == 0) {
+            s = c;
+            break;
+        }
+        if (!c->used || (oldest->used && c->last_s < oldest->last_s)) oldest = c;
+    }
+    if (!s) {
+        s = oldest;
+        memset(s, 0, sizeof(*s));
+        s->used = 1;
+        s->id = id;
+        s->count = count;
+        snprintf(s->source, sizeof(s->source), "%s", source);
+    }
+    s->last_s = time_s;
+
+    unsigned bit = 1u << (index - 1);
+    if (s->have & bit) return 0;
+
+    size_t n = f->info_len - hdr_len;
+    if (n > REASM_MAX_CHUNK) n = REASM_MAX_CHUNK;
+    memcpy(s->chunk[index - 1], f->info + hdr_len, n);
+    s->len[index - 1] = (unsigned)n;
+    s->have |= bit;
+
+    if (s->have != (1u << count) - 1) return 0;
+
+    size_t out = 0;
+    if (size < 2) return 0;
+    info[out++] = '>';
+    for (unsigned i = 0; i < count; i++) {
+        size_t m = s->len[i];
+        if (out + m >= size) m = size - 1 - out;
+        memcpy(info + out, s->chunk[i], m);
+        out += m;
+    }
+    info[out] = 0;
+    s->used = 0;
+    return out;
+}
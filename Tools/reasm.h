@@ -0,0 +1,42 @@
+/* reasm.h
+ * Reassembles fragmented OrbitRadio status records (Core/Inc/frag.h).
+ */
+
+#ifndef REASM_H
+#define REASM_H
+
+#include "ax25.h"
+#include <stddef.h>
+
+#define REASM_SLOTS      8
+#define REASM_MAX_FRAGS  16
+#define REASM_MAX_CHUNK  256
+/* Largest reassembled info field: '>' + all chunks */
+#define REASM_MAX_INFO   (1 + REASM_MAX_FRAGS * REASM_MAX_CHUNK)
+
+typedef struct {
+    int      used;
+    char     source[16];
+    unsigned id, count;
+    unsigned have;                  /* bit per fragment received */
+    double   last_s;
+    unsigned len[REASM_MAX_FRAGS];
+    char     chunk[REASM_MAX_FRAGS][REASM_MAX_CHUNK];
+} reasm_slot_t;
+
+typedef struct {
+    reasm_slot_t slot[REASM_SLOTS];
+} reasm_t;
+
+/* Frame info starts with a fragment header */
+int reasm_is_fragment(const ax25_frame_t *f);
+
+/* Add a fragment. When it completes its record, the original status info
+ * field (">..." as a single frame would have carried it) is written to
+ * info and its length returned; otherwise 0. Repeats are ignored, and the
+ * least recently updated record is dropped when all slots are busy.
+ */
+size_t reasm_add(reasm_t *r, const ax25_frame_t *f, double time_s,
+                 char *info, size_t size);
+
+#endif /* REASM_H */
@@ -0,0 +1,96 @@
+/* telemetry.c
+ * Turns decoded OrbitRadio status frames back into telemetry records.
+ */
+
+#include "telemetry.h"
+#include <ctype.h>
+#include <string.h>
+
+/* Must match the snprintf() format in Core/Src/main.c */
+#define STATUS_DTI     '>'
+#define STATUS_SUFFIX  " | Somaiya OrbitRadio-5 73"
+/* BATCH_SEPARATOR in Core/Inc/batch.h: between OBC lines in one frame */
+#define LINE_SEPARATOR '^'
+
+static void trim_copy(char *dst, size_t n, const char *s, size_t len)
+{
+    while (len && isspace((unsigned char)*s)) { s++; len--; }
+    while (len && isspace((unsigned char)s[len - 1])) len--;
+    if (len >= n) len = n - 1;
+    memcpy(dst, s, len);
+    dst[len] = 0;
+}
+
+/* OBC lines are free text; split "a=1, b:2, 3" style lists into fields */
+static void split_fields(tlm_record_t *rec)
+{
+    const char *p = rec->text;
+
+    while (*p && rec->field_count < TLM_MAX_FIELDS) {
+        size_t len = strcspn(p, ",;");
+        const char *sep = memchr(p, '=', len);
+        if (!sep) sep = memchr(p, ':', len);
+
+        tlm_field_t *f = &rec->fields[rec->field_count];
+        if (sep) {
+            trim_copy(f->key, sizeof(f->key), p, (size_t)(sep - p));
+            trim_copy(f->value, sizeof(f->value), sep + 1, len - (size_t)(sep - p) - 1);
+        } else {
+            f->key[0] = 0;
+            trim_copy(f->value, sizeof(f->value), p, len);
+        }
+        if (f->key[0] || f->value[0]) rec->field_count++;
+
+        p += len;
+        if (*p) p++;
+    }
+}
+
+int tlm_parse(const ax25_frame_t *f, double time_s, unsigned line, tlm_record_t *rec)
+{
+    size_t suffix = strlen(STATUS_SUFFIX);
+
+    if (f->control != AX25_CTRL_UI || f->pid != AX25_PID_NO_L3) return -1;
+    if (f->info_len < 1 + suffix || f->info[0] != STATUS_DTI) return -1;
+    if (memcmp(f->info + f->info_len - suffix, STATUS_SUFFIX, suffix) != 0) return -1;
+
+    /* Find the requested line between the DTI and the suffix */
+    const uint8_t *p = f->info + 1;
+    const uint8_t *end = f->info + f->info_len - suffix;
+    const uint8_t *sep;
+
+    while ((sep = memchr(p, LINE_SEPARATOR, (size_t)(end - p))) && line) {
+        p = sep + 1;
+        line--;
+    }
+    if (line) return -1;
+    if (sep) end = sep;
+
+    memset(rec, 0, sizeof(*rec));
+    rec->time_s = time_s;
+    snprintf(rec->source, sizeof(rec->source), "%s-%u", f->src, f->src_ssid);
+
+    size_t len = (size_t)(end - p);
+    if (len >= sizeof(rec->text)) len = sizeof(rec->text) - 1;
+    memcpy(rec->text, p, len);
+    rec->text[len] = 0;
+
+    split_fields(rec);
+    return 0;
+}
+
+void tlm_print_csv(const tlm_record_t *rec, FILE *out)
+{
+    fprintf(out, "%.3f,%s,\"", rec->time_s, rec->source);
+    for (const char *p = rec->text; *p; p++) {
+        if (*p == '"') fputc('"', out);
+        fputc(*p, out);
+    }
+    fputc('"', out);
+    for (unsigned i = 0; i < rec->field_count; i++) {
+        fputc(i ? ';' : ',', out);
+        if (rec->fields[i].key[0]) fprintf(out, "%s=", rec->fields[i].key);
+        fputs(rec->fields[i].value, out);
+    }
+    fputc('\n', out);
+}
@@ -0,0 +1,38 @@
+/* telemetry.h
+ * Turns decoded OrbitRadio status frames back into telemetry records.
+ * Firmware side: main.c sends ">%s | Somaiya OrbitRadio-5 73".
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "ax25.h"
+#include <stddef.h>
+#include <stdio.h>
+
+#define TLM_MAX_FIELDS  32
+#define TLM_MAX_TEXT    1024   /* LINE_BUF_SIZE in Core/Inc/main.h */
+
+typedef struct {
+    char key[32];      /* empty for positional fields */
+    char value[64];
+} tlm_field_t;
+
+typedef struct {
+    double  time_s;                /* offset into the recording */
+    char    source[16];            /* CALL-SSID */
+    char    text[TLM_MAX_TEXT];    /* OBC line as received on RS-485 */
+    unsigned field_count;
+    tlm_field_t fields[TLM_MAX_FIELDS];
+} tlm_record_t;
+
+/* Parse one OBC line of a decoded frame: a status frame carries one or
+ * more lines, separated by '^' (BATCH_SEPARATOR). Returns 0 if the frame
+ * is an OrbitRadio status frame and has that many lines, -1 otherwise.
+ */
+int tlm_parse(const ax25_frame_t *f, double time_s, unsigned line, tlm_record_t *rec);
+
+/* One CSV line: time,source,"text",key=value;... */
+void tlm_print_csv(const tlm_record_t *rec, FILE *out);
+
+#endif /* TELEMETRY_H */
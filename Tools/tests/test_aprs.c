@@ -0,0 +1,147 @@
+/* test_aprs.c
+ * Mic-E and compressed position encoders against APRS 1.0.1 vectors
+ */
+
+#include "aprs.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* Longitude back from a Mic-E frame, in hundredths of a minute, signed */
+static long mice_lon(const char dest[7], const char *info)
+{
+    long deg = (unsigned char)info[1] - 28;
+    long min = (unsigned char)info[2] - 28;
+    long hun = (unsigned char)info[3] - 28;
+
+    if (dest[4] >= 'P') deg += 100;
+    if (deg >= 180 && deg <= 189) deg -= 80;
+    else if (deg >= 190 && deg <= 199) deg -= 190;
+    if (min >= 60) min -= 60;
+
+    long v = (deg * 60 + min) * 100 + hun;
+    return dest[5] >= 'P' ? -v : v;
+}
+
+static void test_mice_spec(void)
+{
+    /* APRS 1.0.1 chapter 10, destination example: 33 25.64 N, west of
+     * Greenwich below 100 degrees, "Returning" -> S32U6T
+     */
+    aprs_pos_t pos = { 0 };
+    char dest[7], out[64];
+
+    pos.lat = 33427333;         /* 33 25.64' */
+    pos.lon = -72750000;
+    pos.table = '/';
+    pos.symbol = 'j';
+    CHECK(APRS_FormatMicE(dest, out, sizeof(out), &pos, APRS_MICE_RETURNING, NULL) == 9);
+    CHECK(strcmp(dest, "S32U6T") == 0);
+
+    /* Information field example: 112 07.74 W, 20 kn, 251 deg -> `(_fn"O.
+     * 112 needs the +100 offset flag in the 5th destination character.
+     */
+    pos.lon = -112129000;       /* 112 07.74' */
+    pos.speed = 20;
+    pos.course = 251;
+    CHECK(APRS_FormatMicE(dest, out, sizeof(out), &pos, APRS_MICE_RETURNING, NULL) == 9);
+    CHECK(strcmp(dest, "S32UVT") == 0);
+    CHECK(strcmp(out, "`(_fn\"Oj/") == 0);
+    CHECK(mice_lon(dest, out) == -(112L * 6000 + 774));
+
+    /* Altitude and comment */
+    pos.has_alt = 1;
+    pos.alt = 61;               /* 10061 m over -10 km: "\"4T" */
+    CHECK(APRS_FormatMicE(dest, out, sizeof(out), &pos, APRS_MICE_RETURNING, "Hi") == 15);
+    CHECK(strcmp(out + 9, "\"4T}Hi") == 0);
+
+    /* Does not fit */
+    CHECK(APRS_FormatMicE(dest, out, 15, &pos, APRS_MICE_RETURNING, "Hi") == -1);
+}
+
+static void test_mice_longitudes(void)
+{
+    static const struct { long udeg; long hmin; } cases[] = {
+        {          0,                 0 },
+        {    9999000,    9L * 6000 + 5994 },
+        {   10000000,   10L * 6000 },
+        {   99999999,  100L * 6000 },          /* rounds up into 100 */
+        {  109500000,  109L * 6000 + 3000 },
+        {  110000000,  110L * 6000 },
+        {  179999000,  179L * 6000 + 5994 },
+        {  179999999,  179L * 6000 + 5999 },   /* would round to 180 */
+        {  180000000,  179L * 6000 + 5999 },
+        { -180000000, -(179L * 6000 + 5999) },
+    };
+    aprs_pos_t pos = { 0 };
+    char dest[7], out[32];
+
+    pos.table = '/';
+    pos.symbol = '>';
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        pos.lon = (int32_t)cases[i].udeg;
+        CHECK(APRS_FormatMicE(dest, out, sizeof(out), &pos, APRS_MICE_OFF_DUTY, NULL) == 9);
+        if (mice_lon(dest, out) != cases[i].hmin) {
+            fprintf(stderr, "lon %ld: got %ld, want %ld\n",
+                    cases[i].udeg, mice_lon(dest, out), cases[i].hmin);
+            failures++;
+        }
+        for (int k = 0; k < 9; k++) CHECK(out[k] != 0);
+    }
+}
+
+static void test_compressed_spec(void)
+{
+    /* APRS 1.0.1 chapter 9: 49 30' N, 72 45' W -> "5L!!<*e7", course 88
+     * and 36.2 kn -> "7P" (T is ours: current fix, software)
+     */
+    aprs_pos_t pos = { 0 };
+    char out[64];
+
+    pos.lat = 49500000;
+    pos.lon = -72750000;
+    pos.course = 88;
+    pos.speed = 36;
+    pos.table = '/';
+    pos.symbol = '>';
+    CHECK(APRS_FormatCompressedPosition(out, sizeof(out), &pos, NULL) == 14);
+    CHECK(strcmp(out, "!/5L!!<*e7>7PC") == 0);
+
+    /* No course or speed: three spaces */
+    pos.course = 0;
+    pos.speed = 0;
+    CHECK(APRS_FormatCompressedPosition(out, sizeof(out), &pos, "x") == 15);
+    CHECK(strcmp(out, "!/5L!!<*e7>   x") == 0);
+
+    /* The corners stay inside four base91 digits */
+    pos.lat = -90000000;
+    pos.lon = 180000000;
+    CHECK(APRS_FormatCompressedPosition(out, sizeof(out), &pos, NULL) == 14);
+    CHECK(strncmp(out + 2, "{{!!{{!!", 8) == 0);
+    pos.lat = 90000000;
+    pos.lon = -180000000;
+    CHECK(APRS_FormatCompressedPosition(out, sizeof(out), &pos, NULL) == 14);
+    CHECK(strncmp(out + 2, "!!!!!!!!", 8) == 0);
+}
+
+int main(void)
+{
+    test_mice_spec();
+    test_mice_longitudes();
+    test_compressed_spec();
+
+    if (failures) {
+        fprintf(stderr, "test_aprs: %d failed\n", failures);
+        return 1;
+    }
+    printf("test_aprs: ok\n");
+    return 0;
+}
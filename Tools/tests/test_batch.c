@@ -0,0 +1,129 @@
+/* test_batch.c
+ * Batched status lines survive the trip through Tools/telemetry.c
+ */
+
+#include "batch.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* STATUS_SUFFIX in Core/Src/main.c */
+#define SUFFIX " | Somaiya OrbitRadio-5 73"
+
+static void frame_of(ax25_frame_t *f, const char *info)
+{
+    memset(f, 0, sizeof(*f));
+    strcpy(f->src, "VU2XYZ");
+    f->src_ssid = 11;
+    f->control = AX25_CTRL_UI;
+    f->pid = AX25_PID_NO_L3;
+    f->info = (const uint8_t *)info;
+    f->info_len = (uint16_t)strlen(info);
+}
+
+static unsigned count_lines(const ax25_frame_t *f)
+{
+    static tlm_record_t rec;
+    unsigned n = 0;
+
+    while (tlm_parse(f, 0.0, n, &rec) == 0) n++;
+    return n;
+}
+
+static void test_round_trip(void)
+{
+    static batch_t b;
+    static tlm_record_t rec;
+    ax25_frame_t f;
+
+    batch_Init(&b, ">", SUFFIX);
+    CHECK(batch_add(&b, "bat=7.4, temp=21", 0) == 0);
+    CHECK(batch_add(&b, "mode:SAFE; rssi:-97", 10) == 0);
+    CHECK(batch_add(&b, "42", 20) == 0);
+    frame_of(&f, batch_payload(&b));
+
+    CHECK(count_lines(&f) == 3);
+
+    CHECK(tlm_parse(&f, 1.5, 0, &rec) == 0);
+    CHECK(strcmp(rec.text, "bat=7.4, temp=21") == 0);
+    CHECK(strcmp(rec.source, "VU2XYZ-11") == 0);
+    CHECK(rec.time_s == 1.5);
+    CHECK(rec.field_count == 2);
+    CHECK(strcmp(rec.fields[0].key, "bat") == 0);
+    CHECK(strcmp(rec.fields[0].value, "7.4") == 0);
+    CHECK(strcmp(rec.fields[1].key, "temp") == 0);
+    CHECK(strcmp(rec.fields[1].value, "21") == 0);
+
+    CHECK(tlm_parse(&f, 1.5, 1, &rec) == 0);
+    CHECK(strcmp(rec.text, "mode:SAFE; rssi:-97") == 0);
+    CHECK(rec.field_count == 2);
+    CHECK(strcmp(rec.fields[0].key, "mode") == 0);
+    CHECK(strcmp(rec.fields[0].value, "SAFE") == 0);
+    CHECK(strcmp(rec.fields[1].key, "rssi") == 0);
+    CHECK(strcmp(rec.fields[1].value, "-97") == 0);
+
+    CHECK(tlm_parse(&f, 1.5, 2, &rec) == 0);
+    CHECK(strcmp(rec.text, "42") == 0);
+    CHECK(rec.field_count == 1);
+    CHECK(rec.fields[0].key[0] == 0);
+    CHECK(strcmp(rec.fields[0].value, "42") == 0);
+}
+
+static void test_single_line(void)
+{
+    static batch_t b;
+    ax25_frame_t f;
+
+    batch_Init(&b, ">", SUFFIX);
+    CHECK(batch_add(&b, "a=1;b=2", 0) == 0);
+    frame_of(&f, batch_payload(&b));
+    CHECK(count_lines(&f) == 1);
+
+    /* Not a status frame */
+    frame_of(&f, ":VU2XYZ   :hello");
+    CHECK(count_lines(&f) == 0);
+}
+
+static void test_full(void)
+{
+    static batch_t b;
+    char line[64];
+    unsigned added = 0;
+    ax25_frame_t f;
+
+    /* Fill to the APRS limit: every line that fit comes back */
+    batch_Init(&b, ">", SUFFIX);
+    for (;;) {
+        snprintf(line, sizeof(line), "seq=%u, v=%u", added, added * 3);
+        if (batch_add(&b, line, 0) != 0) break;
+        added++;
+    }
+    const char *payload = batch_payload(&b);
+    CHECK(strlen(payload) <= BATCH_MAX_PAYLOAD);
+    frame_of(&f, payload);
+    CHECK(added > 1);
+    CHECK(count_lines(&f) == added);
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_single_line();
+    test_full();
+
+    if (failures) {
+        fprintf(stderr, "test_batch: %d failed\n", failures);
+        return 1;
+    }
+    printf("test_batch: ok\n");
+    return 0;
+}
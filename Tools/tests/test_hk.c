@@ -0,0 +1,196 @@
+/* test_hk.c
+ * Housekeeping frames from Core/Src/tlm.c decode back to the same values
+ */
+
+#include "hk.h"
+#include "tlm.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* Fields of the housekeeping record, in schema order */
+typedef struct {
+    uint16_t vbat;
+    int16_t  ibat;
+    uint16_t vsol;
+    int16_t  tobc, tpa;
+    uint8_t  flags;
+    uint32_t uptime;
+    uint16_t resets;
+} hk_in_t;
+
+static void put16(uint8_t **p, uint16_t v) { *(*p)++ = (uint8_t)v; *(*p)++ = (uint8_t)(v >> 8); }
+
+static void load(const hk_in_t *in)
+{
+    uint8_t rec[32], *p = rec;
+
+    *p++ = TLM_RECORD_HK;
+    put16(&p, in->vbat);
+    put16(&p, (uint16_t)in->ibat);
+    put16(&p, in->vsol);
+    put16(&p, (uint16_t)in->tobc);
+    put16(&p, (uint16_t)in->tpa);
+    *p++ = in->flags;
+    put16(&p, (uint16_t)in->uptime);
+    put16(&p, (uint16_t)(in->uptime >> 16));
+    put16(&p, in->resets);
+    CHECK(tlm_decode(rec, (uint16_t)(p - rec)) == 0);
+}
+
+static void frame_of(ax25_frame_t *f, const char *info)
+{
+    memset(f, 0, sizeof(*f));
+    strcpy(f->src, "ORBITR");
+    f->src_ssid = 5;
+    f->control = AX25_CTRL_UI;
+    f->pid = AX25_PID_NO_L3;
+    f->info = (const uint8_t *)info;
+    f->info_len = (uint16_t)strlen(info);
+}
+
+/* Ground state matches what the firmware holds in its slots */
+static void check_state(const hk_state_t *s)
+{
+    for (uint8_t i = 0; i < tlm_fieldCount(); i++) {
+        const tlm_field_t *f = tlm_field(i);
+        if (f->channel == TLM_CH_NONE) {
+            CHECK(s->value[i] == (int64_t)tlm_get(i).u);
+        } else if (f->channel == TLM_CH_DIGITAL) {
+            CHECK(s->value[i] == (int64_t)tlm_get(i).u);
+        } else {
+            CHECK(s->value[i] == tlm_aprsValue(i));
+        }
+    }
+}
+
+static int send(hk_state_t *s, uint16_t *seq)
+{
+    char out[128];
+    ax25_frame_t f;
+    int n = tlm_formatDelta(out, sizeof(out), *seq);
+
+    if (n <= 0) return n;
+    *seq = (uint16_t)(*seq + 1);
+    frame_of(&f, out);
+    CHECK(hk_is_frame(&f));
+    return hk_apply(s, &f) == 0 ? n : -1;
+}
+
+static void test_full_then_deltas(void)
+{
+    hk_state_t s;
+    uint16_t seq = 0;
+    hk_in_t in = { 7400, -250, 16000, 215, 480, 0x24, 86400, 3 };
+
+    memset(&s, 0, sizeof(s));
+    tlm_Init();
+
+    load(&in);
+    CHECK(send(&s, &seq) > 0);
+    CHECK(s.valid && !s.stale);
+    check_state(&s);
+
+    /* Below every deadband: nothing goes out */
+    in.vbat += 10;
+    load(&in);
+    CHECK(send(&s, &seq) == 0);
+
+    /* Vbat, Flags and Uptime move */
+    in.vbat = 7000;
+    in.flags = 0x81;
+    in.uptime += 3600;
+    load(&in);
+    CHECK(send(&s, &seq) > 0);
+    CHECK(!s.stale);
+    check_state(&s);
+
+    /* Negative raw values through the offset */
+    in.ibat = -3999;
+    in.tpa = -395;
+    load(&in);
+    CHECK(send(&s, &seq) > 0);
+    check_state(&s);
+}
+
+static void test_delta_needs_full(void)
+{
+    hk_state_t s;
+    ax25_frame_t f;
+
+    memset(&s, 0, sizeof(s));
+    frame_of(&f, ">D!\"a!!");
+    CHECK(hk_is_frame(&f));
+    CHECK(hk_apply(&s, &f) == -1);
+    CHECK(!s.valid);
+}
+
+static void test_gap_is_stale(void)
+{
+    hk_state_t s;
+    uint16_t seq = 0;
+    hk_in_t in = { 7400, -250, 16000, 215, 480, 0x00, 100, 1 };
+
+    memset(&s, 0, sizeof(s));
+    tlm_Init();
+    load(&in);
+    CHECK(send(&s, &seq) > 0);
+
+    /* A delta that never arrives */
+    char out[128];
+    in.resets = 2;
+    load(&in);
+    CHECK(tlm_formatDelta(out, sizeof(out), seq++) > 0);
+
+    in.vsol = 1000;
+    load(&in);
+    CHECK(send(&s, &seq) > 0);
+    CHECK(s.stale);
+}
+
+static void test_no_room_keeps_baseline(void)
+{
+    hk_state_t s;
+    uint16_t seq = 0;
+    char small[8];
+    hk_in_t in = { 7400, -250, 16000, 215, 480, 0x00, 100, 1 };
+
+    memset(&s, 0, sizeof(s));
+    tlm_Init();
+    load(&in);
+    CHECK(send(&s, &seq) > 0);
+
+    /* Two fields move, but only one fits: nothing counts as sent */
+    in.vbat = 6000;
+    in.resets = 9;
+    load(&in);
+    CHECK(tlm_formatDelta(small, sizeof(small), seq) == -1);
+
+    /* Retried with room, both fields still go out */
+    CHECK(send(&s, &seq) > 0);
+    CHECK(!s.stale);
+    check_state(&s);
+}
+
+int main(void)
+{
+    test_full_then_deltas();
+    test_delta_needs_full();
+    test_gap_is_stale();
+    test_no_room_keeps_baseline();
+
+    if (failures) {
+        fprintf(stderr, "test_hk: %d failed\n", failures);
+        return 1;
+    }
+    printf("test_hk: ok\n");
+    return 0;
+}
@@ -0,0 +1,218 @@
+/* test_obc_link.c
+ * OBC link receiver: records, and text lines after a stray zero
+ */
+
+#include "obc_link.h"
+#include "ax25.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+/* What main.c does with the receiver's output: text bytes build a line,
+ * records are counted
+ */
+static char line[256];
+static size_t line_len;
+static char last_line[256];
+static int lines, records, errors;
+
+static void text_byte(uint8_t b)
+{
+    if (b == '\r') return;
+    if (b == '\n') {
+        line[line_len] = '\0';
+        strcpy(last_line, line);
+        line_len = 0;
+        lines++;
+        return;
+    }
+    if (line_len < sizeof(line) - 1) line[line_len++] = (char)b;
+}
+
+static void handle(obc_link_t *l, obc_rx_t rx, uint8_t b)
+{
+    switch (rx) {
+    case OBC_RX_TEXT:
+        text_byte(b);
+        break;
+    case OBC_RX_RECORD:
+        records++;
+        break;
+    case OBC_RX_ERROR:
+        errors++;
+        break;
+    case OBC_RX_REPLAY:
+        for (uint16_t i = 0; i < l->text_len; i++) text_byte(l->text[i]);
+        break;
+    default:
+        break;
+    }
+}
+
+static void feed(obc_link_t *l, const uint8_t *p, size_t n)
+{
+    for (size_t i = 0; i < n; i++) handle(l, obc_link_rx(l, p[i]), p[i]);
+}
+
+static void idle(obc_link_t *l)
+{
+    handle(l, obc_link_idle(l), 0);
+}
+
+static void reset(obc_link_t *l)
+{
+    obc_link_Init(l);
+    line_len = 0;
+    last_line[0] = '\0';
+    lines = records = errors = 0;
+}
+
+/* 00 COBS(rec, crc) 00 */
+static size_t frame(const uint8_t *rec, uint16_t n, uint8_t *out)
+{
+    uint8_t raw[OBC_LINK_MAX_RECORD + OBC_LINK_CRC_LEN];
+    uint16_t crc = ax25_fcs(rec, n);
+    size_t o = 0, code_at;
+
+    memcpy(raw, rec, n);
+    raw[n] = (uint8_t)crc;
+    raw[n + 1] = (uint8_t)(crc >> 8);
+    n += OBC_LINK_CRC_LEN;
+
+    out[o++] = 0;
+    code_at = o++;
+    for (uint16_t i = 0; i < n; i++) {
+        if (raw[i] == 0) {
+            out[code_at] = (uint8_t)(o - code_at);
+            code_at = o++;
+        } else {
+            out[o++] = raw[i];
+        }
+    }
+    out[code_at] = (uint8_t)(o - code_at);
+    out[o++] = 0;
+    return o;
+}
+
+static void test_record(void)
+{
+    obc_link_t l;
+    const uint8_t rec[] = { 0x01, 0x00, 0x42, 0x00, 0x07 };
+    uint8_t buf[64];
+    size_t n = frame(rec, sizeof(rec), buf);
+
+    reset(&l);
+    feed(&l, buf, n);
+    CHECK(records == 1);
+    CHECK(l.rec_len == sizeof(rec));
+    CHECK(memcmp(l.rec, rec, sizeof(rec)) == 0);
+
+    /* Text right after the frame goes straight through */
+    feed(&l, (const uint8_t *)"$STATS\n", 7);
+    CHECK(lines == 1);
+    CHECK(strcmp(last_line, "$STATS") == 0);
+}
+
+static void test_stray_zero_then_idle(void)
+{
+    obc_link_t l;
+    const uint8_t in[] = "\0$STATS\n";
+
+    /* The command is held as a frame until the line goes idle */
+    reset(&l);
+    feed(&l, in, sizeof(in) - 1);
+    CHECK(lines == 0);
+    idle(&l);
+    CHECK(lines == 1);
+    CHECK(strcmp(last_line, "$STATS") == 0);
+    CHECK(errors == 0);
+    CHECK(l.binary == 0);
+
+    /* And the next command is plain text again */
+    feed(&l, (const uint8_t *)"$PING\n", 6);
+    CHECK(lines == 2);
+    CHECK(strcmp(last_line, "$PING") == 0);
+}
+
+static void test_stray_zero_then_frame(void)
+{
+    obc_link_t l;
+    const uint8_t rec[] = { 0x02, 0x10, 0x20 };
+    uint8_t buf[64];
+    size_t n;
+
+    /* The frame's opening zero closes the "frame" the stray zero opened:
+     * the text is replayed and the record still arrives
+     */
+    reset(&l);
+    feed(&l, (const uint8_t *)"\0$STATS\n", 8);
+    n = frame(rec, sizeof(rec), buf);
+    feed(&l, buf, n);
+    CHECK(lines == 1);
+    CHECK(strcmp(last_line, "$STATS") == 0);
+    CHECK(records == 1);
+    CHECK(errors == 0);
+}
+
+static void test_overflow(void)
+{
+    obc_link_t l;
+    char text[OBC_LINK_MAX_FRAME + 16];
+
+    /* A line longer than any frame drops back to text on overflow */
+    memset(text, 'A', sizeof(text));
+    text[0] = '$';
+    text[sizeof(text) - 1] = '\n';
+
+    reset(&l);
+    feed(&l, (const uint8_t *)"\0", 1);
+    feed(&l, (const uint8_t *)text, sizeof(text));
+    CHECK(l.binary == 0);
+    CHECK(lines == 1);
+    CHECK(strlen(last_line) == sizeof(text) - 1);
+    CHECK(last_line[0] == '$');
+}
+
+static void test_bad_frame(void)
+{
+    obc_link_t l;
+    const uint8_t rec[] = { 0x03, 0x80, 0xFF };
+    uint8_t buf[64];
+    size_t n = frame(rec, sizeof(rec), buf);
+
+    /* Corrupt CRC: counted, not replayed */
+    buf[n - 2] ^= 0x55;
+    reset(&l);
+    feed(&l, buf, n);
+    CHECK(errors == 1);
+    CHECK(records == 0);
+    CHECK(l.frames_bad == 1);
+    idle(&l);
+    CHECK(l.binary == 0);
+    feed(&l, (const uint8_t *)"$STATS\n", 7);
+    CHECK(lines == 1);
+}
+
+int main(void)
+{
+    test_record();
+    test_stray_zero_then_idle();
+    test_stray_zero_then_frame();
+    test_overflow();
+    test_bad_frame();
+
+    if (failures) {
+        fprintf(stderr, "test_obc_link: %d failed\n", failures);
+        return 1;
+    }
+    printf("test_obc_link: ok\n");
+    return 0;
+}
@@ -0,0 +1,200 @@
+/* trace_parse.c
+ * Turns an SWO capture of the ITM event trace (Core/Inc/trace.h) into a
+ * timeline and timing summary.
+ *
+ * Input is the raw ITM packet stream (SWO pin through a USB-UART at
+ * TRACE_SWO_HZ, or a probe's SWO capture file). Events carry 24-bit DWT
+ * stamps, extended to 64 bits with the sync port. Tick events carry a
+ * sequence number: a period or ISR time that spans a dropped tick event
+ * is left out of the summary and counted as a gap.
+ *
+ * usage: trace_parse [-f core_hz] [-s] [capture.bin]
+ *   -f  core clock for the time column (default 16000000)
+ *   -s  summary only, no timeline
+ */
+
+#include "trace_ev.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* A main-loop event can reach the FIFO after an ISR event stamped later;
+ * stamps this far behind the last one are late, not wrapped
+ */
+#define REORDER_CYCLES  (1ULL << 20)
+
+static const char *const names[TRACE_EVENT_COUNT] = {
+    "none",
+#define TRACE_EV_NAME(ev, name) name,
+    TRACE_EVENTS(TRACE_EV_NAME)
+#undef TRACE_EV_NAME
+};
+
+typedef struct {
+    unsigned long n;
+    uint64_t min, max, sum;
+} span_t;
+
+static void span_add(span_t *s, uint64_t v)
+{
+    if (s->n == 0 || v < s->min) s->min = v;
+    if (s->n == 0 || v > s->max) s->max = v;
+    s->sum += v;
+    s->n++;
+}
+
+static void span_print(const char *what, const span_t *s, double hz)
+{
+    if (s->n == 0) return;
+    printf("# %-12s n=%-8lu min %8llu  avg %10.1f  max %8llu cycles  (max %.3f us)\n",
+           what, s->n, (unsigned long long)s->min, (double)s->sum / s->n,
+           (unsigned long long)s->max, s->max * 1e6 / hz);
+}
+
+int main(int argc, char **argv)
+{
+    double hz = 16e6;
+    int summary_only = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:s")) != -1) {
+        switch (opt) {
+        case 'f': hz = strtod(optarg, NULL); break;
+        case 's': summary_only = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-f core_hz] [-s] [capture.bin]\n", argv[0]);
+            return 2;
+        }
+    }
+    FILE *in = stdin;
+    if (optind < argc && !(in = fopen(argv[optind], "rb"))) {
+        perror(argv[optind]);
+        return 1;
+    }
+    if (hz <= 0) hz = 16e6;
+
+    uint64_t now = 0;           /* extended cycle count of the last stamp */
+    int synced = 0;
+    uint64_t tick_in = 0, last_tick_in = 0, frame_start = 0, ptt_on = 0;
+    int in_tick = 0, in_frame = 0, keyed = 0, have_tick = 0;
+    unsigned tick_seq = 0;
+    unsigned long gaps = 0;
+    span_t isr = { 0 }, period = { 0 }, frame = { 0 }, ptt = { 0 };
+    unsigned long counts[TRACE_EVENT_COUNT] = { 0 };
+    unsigned long overflows = 0, unknown = 0;
+    int h;
+
+    while ((h = getc(in)) != EOF) {
+        if (h == 0x00 || h == 0x80) continue;       /* synchronisation */
+        if (h == 0x70) {
+            overflows++;
+            in_tick = have_tick = 0;
+            if (!summary_only) printf("# ITM overflow\n");
+            continue;
+        }
+        if ((h & 0x03) == 0) {
+            /* Timestamp / extension packet: skip continuation bytes */
+            int c = h;
+            while ((c & 0x80) && (c = getc(in)) != EOF) {}
+            continue;
+        }
+
+        unsigned size = (h & 0x03) == 3 ? 4 : (h & 0x03);
+        uint32_t v = 0;
+        for (unsigned i = 0; i < size; i++) {
+            int c = getc(in);
+            if (c == EOF) break;
+            v |= (uint32_t)c << (8 * i);
+        }
+        if (h & 0x04) continue;                     /* hardware source (DWT) */
+
+        unsigned port = (unsigned)h >> 3;
+        if (port == TRACE_PORT_SYNC && size == 4) {
+            /* Full 32-bit count; keep the 64-bit epoch monotonic */
+            uint64_t t = (now & ~0xFFFFFFFFULL) | v;
+            if (synced && t + REORDER_CYCLES < now) t += 1ULL << 32;
+            if (t > now || !synced) now = t;
+            synced = 1;
+            continue;
+        }
+        if (port == 0 || port >= TRACE_EVENT_COUNT || size != 4) {
+            unknown++;
+            continue;
+        }
+
+        /* Extend the 24-bit stamp: events are less than 2^24 cycles apart,
+         * or a sync came in between
+         */
+        uint64_t t = (now & ~(uint64_t)TRACE_STAMP_MASK) | (v & TRACE_STAMP_MASK);
+        if (t + REORDER_CYCLES < now) t += TRACE_STAMP_MASK + 1ULL;
+        if (t > now) now = t;
+        unsigned arg = v >> 24;
+        counts[port]++;
+
+        switch (port) {
+        case TRACE_TICK_IN:
+            if (in_tick) gaps++;                    /* its tick_out was lost */
+            if (have_tick) {
+                if (arg == ((tick_seq + 1) & 0xFF)) span_add(&period, t - last_tick_in);
+                else gaps++;
+            }
+            last_tick_in = tick_in = t;
+            tick_seq = arg;
+            in_tick = have_tick = 1;
+            break;
+        case TRACE_TICK_OUT:
+            if (in_tick && arg == tick_seq) span_add(&isr, t - tick_in);
+            else if (have_tick) gaps++;
+            in_tick = 0;
+            break;
+        case TRACE_FRAME_START:
+            frame_start = t;
+            in_frame = 1;
+            break;
+        case TRACE_FRAME_END:
+            if (in_frame) span_add(&frame, t - frame_start);
+            in_frame = 0;
+            /* Idle ticks have no period of interest */
+            have_tick = 0;
+            break;
+        case TRACE_PTT_ON:
+            ptt_on = t;
+            keyed = 1;
+            break;
+        case TRACE_PTT_OFF:
+            if (keyed) span_add(&ptt, t - ptt_on);
+            keyed = 0;
+            break;
+        default:
+            break;
+        }
+
+        if (summary_only) continue;
+        /* Ticks are listed only while a frame is on air; idle ones would drown the rest */
+        if ((port == TRACE_TICK_IN || port == TRACE_TICK_OUT) && !in_frame) continue;
+        printf("%14.3f us  %s", t * 1e6 / hz, names[port]);
+        if (port >= TRACE_Q_PUSH) printf(" class %u", arg);
+        printf("\n");
+    }
+
+    printf("# events:");
+    for (unsigned i = 1; i < TRACE_EVENT_COUNT; i++) {
+        if (counts[i]) printf(" %s=%lu", names[i], counts[i]);
+    }
+    printf("\n");
+    span_print("tick isr", &isr, hz);
+    span_print("tick period", &period, hz);
+    span_print("frame", &frame, hz);
+    span_print("ptt", &ptt, hz);
+    if (period.n) {
+        printf("# tick jitter %llu cycles peak-to-peak\n",
+               (unsigned long long)(period.max - period.min));
+    }
+    if (gaps) printf("# %lu tick samples left out: tick events lost\n", gaps);
+    if (overflows || unknown) printf("# %lu overflows, %lu unknown packets\n", overflows, unknown);
+
+    if (in != stdin) fclose(in);
+    return 0;
+}
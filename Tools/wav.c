@@ -0,0 +1,79 @@
+/* wav.c
+ * Minimal RIFF/WAVE reader for recorded passes (16-bit PCM, any rate)
+ */
+
+#include "wav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t rd32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+int wav_load(const char *path, wav_t *w)
+{
+    memset(w, 0, sizeof(*w));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    uint8_t hdr[12];
+    if (fread(hdr, 1, 12, f) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+        fprintf(stderr, "%s: not a RIFF/WAVE file\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    uint16_t channels = 0, bits = 0, format = 0;
+    uint8_t ck[8];
+    while (fread(ck, 1, 8, f) == 8) {
+        uint32_t size = rd32(ck + 4);
+
+        if (!memcmp(ck, "fmt ", 4)) {
+            uint8_t fmt[16];
+            if (size < 16 || fread(fmt, 1, 16, f) != 16) break;
+            format = rd16(fmt);
+            channels = rd16(fmt + 2);
+            w->sample_rate = rd32(fmt + 4);
+            bits = rd16(fmt + 14);
+            fseek(f, (long)(size - 16 + (size & 1)), SEEK_CUR);
+        } else if (!memcmp(ck, "data", 4)) {
+            if (format != 1 || bits != 16 || channels == 0) {
+                fprintf(stderr, "%s: only 16-bit PCM is supported\n", path);
+                break;
+            }
+            size_t frames = size / (2u * channels);
+            int16_t *raw = malloc(frames * 2u * channels);
+            w->samples = malloc(frames * sizeof(float));
+            if (!raw || !w->samples) {
+                free(raw);
+                break;
+            }
+            frames = fread(raw, 2u * channels, frames, f);
+            for (size_t i = 0; i < frames; i++) {
+                w->samples[i] = (int16_t)rd16((const uint8_t *)&raw[i * channels]) / 32768.0f;
+            }
+            w->count = frames;
+            free(raw);
+            fclose(f);
+            return 0;
+        } else {
+            fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+
+    fprintf(stderr, "%s: no usable data chunk\n", path);
+    wav_free(w);
+    fclose(f);
+    return -1;
+}
+
+void wav_free(wav_t *w)
+{
+    free(w->samples);
+    w->samples = NULL;
+    w->count = 0;
+}
@@ -0,0 +1,22 @@
+/* wav.h
+ * Minimal RIFF/WAVE reader for recorded passes (16-bit PCM, any rate)
+ */
+
+#ifndef WAV_H
+#define WAV_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+    float   *samples;      /* first channel, scaled to -1.0 .. +1.0 */
+    size_t   count;
+    uint32_t sample_rate;
+} wav_t;
+
+/* Load a WAV file. Returns 0 on success, -1 on error (message on stderr). */
+int wav_load(const char *path, wav_t *w);
+
+void wav_free(wav_t *w);
+
+#endif /* WAV_H */